@@ -1,19 +1,20 @@
 #include "aerenderer.h"
 #include <QtDebug>
 
-//The unique instance is nullptr until instance() has been called once.
-AERenderer *AERenderer::_instance = nullptr;
+// Each process renders this number of ranges on average, so that the last ones are well balanced
+#define RANGES_PER_PROCESS 4
+// The minimum number of frames in a range, as launching aerender takes some time
+#define MIN_RANGE_FRAMES 10
 
-AERenderer *AERenderer::instance()
-{
-    if (!_instance) _instance = new AERenderer();
-    return _instance;
-}
+//Templates are installed by default, unless a script has already set them.
+bool AERenderer::_setTemplates = true;
 
 AERenderer::AERenderer(QObject *parent) : AbstractRenderer(parent)
 {
     _duration = 0;
-    _setTemplates = true;
+    _startFrame = 0;
+    _audioProcessId = -1;
+    _templatesSet = false;
     connect(AfterEffects::instance(), &AfterEffects::binaryChanged, this, &AbstractRenderer::setBinary);
     setBinary(AfterEffects::instance()->binary());
 }
@@ -53,6 +54,15 @@ void AERenderer::renderAep(MediaInfo *aep, bool audio)
     arguments <<  QDir::toNativeSeparators(aep->fileName());
 
     QString tempPath = "";
+    _rangeArguments.clear();
+    _pendingRanges.clear();
+    _processFirstFrames.clear();
+    _processRanges.clear();
+    _rangeProcesses.clear();
+    _processRenderedFrames.clear();
+    _completedRanges.clear();
+    _audioProcessId = -1;
+    _startFrame = aep->aepStartFrame();
 
     qDebug() << "Here's the project: " + QDir::toNativeSeparators(aep->fileName());
 
@@ -96,7 +106,13 @@ void AERenderer::renderAep(MediaInfo *aep, bool audio)
         }
 
         // (Try to) Add our templates for rendering
-        if (_setTemplates) AfterEffects::instance()->setDuMETemplates();
+        if (_setTemplates)
+        {
+            // The previous render may not have released them
+            restoreTemplates();
+            AfterEffects::instance()->setDuMETemplates();
+            _templatesSet = true;
+        }
     }
 
     qDebug() << "Beginning After Effects rendering\nUsing aerender command:\n" + arguments.join(" | ");
@@ -113,19 +129,137 @@ void AERenderer::renderAep(MediaInfo *aep, bool audio)
     this->setNumFrames( int( aep->duration() * vStreams[0]->framerate() ) );
     this->setFrameRate( vStreams[0]->framerate() );
     this->setOutputFileName( tempPath );
+    // aerender replaces [#####] with the frame numbers and adds the extension
+    if (tempPath != "")
+    {
+        QFileInfo outputFile( QDir::fromNativeSeparators(tempPath) );
+        outputTracker()->setOutput( outputFile.path(), "*.exr" );
+    }
 
     qDebug() << "Starting...";
 
-    this->start( arguments, numThreads );
-    // audio
-    if (audio) this->start( audioArguments );
+    // The ranges can't be set without knowing the frame numbers of the composition
+    if (!aep->aeUseRQueue() && _numFrames > 0 && _startFrame >= 0)
+    {
+        // Each process renders its own ranges of frames
+        _rangeArguments = arguments;
+        splitRanges(_numFrames, numThreads);
+        QList<QStringList> argumentsList;
+        while (argumentsList.count() < numThreads && _pendingRanges.count() > 0)
+        {
+            QPair<int, int> range = _pendingRanges.takeFirst();
+            // Ids are given in launch order
+            int id = argumentsList.count();
+            _processRanges.insert(id, range);
+            _rangeProcesses.insert(range.first, id);
+            argumentsList << ( QStringList(_rangeArguments) << "-s" << QString::number(_startFrame + range.first) << "-e" << QString::number(_startFrame + range.second) );
+        }
+        // audio
+        if (audio)
+        {
+            _audioProcessId = argumentsList.count();
+            argumentsList << audioArguments;
+        }
+        this->start( argumentsList );
+    }
+    else
+    {
+        this->start( arguments, numThreads );
+        // audio
+        if (audio)
+        {
+            _audioProcessId = numThreads;
+            this->start( audioArguments );
+        }
+    }
 
     setStatus( MediaUtils::AERendering );
 
     qDebug() << "Launched!";
 }
 
-bool AERenderer::isUsingTemplates() const
+void AERenderer::splitRanges(int numFrames, int numProcesses)
+{
+    _pendingRanges.clear();
+
+    int numRanges = 1;
+    if (numProcesses > 1) numRanges = numProcesses * RANGES_PER_PROCESS;
+    int rangeFrames = numFrames / numRanges;
+    if (numFrames % numRanges != 0) rangeFrames++;
+    if (numProcesses > 1 && rangeFrames < MIN_RANGE_FRAMES) rangeFrames = MIN_RANGE_FRAMES;
+
+    for (int first = 0; first < numFrames; first += rangeFrames)
+    {
+        int last = first + rangeFrames - 1;
+        if (last >= numFrames) last = numFrames - 1;
+        _pendingRanges << QPair<int, int>(first, last);
+    }
+
+    emit newLog( "Rendering " + QString::number(numFrames) + " frames in " + QString::number(_pendingRanges.count()) + " ranges.", LogUtils::Debug );
+}
+
+bool AERenderer::launchNextRange()
+{
+    if (_pendingRanges.isEmpty()) return false;
+
+    launchRange( _pendingRanges.takeFirst() );
+    return true;
+}
+
+void AERenderer::launchRange(QPair<int, int> range)
+{
+    QStringList arguments = _rangeArguments;
+    arguments << "-s" << QString::number(_startFrame + range.first) << "-e" << QString::number(_startFrame + range.second);
+    int id = launchProcess( arguments );
+    _processRanges.insert(id, range);
+    _rangeProcesses.insert(range.first, id);
+
+    emit newLog( "Process " + QString::number(id + 1) + " renders frames " + QString::number(_startFrame + range.first) + " to " + QString::number(_startFrame + range.second) + ".", LogUtils::Debug );
+}
+
+int AERenderer::completedFrames() const
+{
+    int frames = 0;
+    // The ranges are launched in order
+    QMapIterator<int, int> it(_rangeProcesses);
+    while (it.hasNext())
+    {
+        it.next();
+        if (it.key() != frames) break;
+        int id = it.value();
+        if (_completedRanges.contains(id))
+        {
+            frames = _processRanges.value(id).second + 1;
+            continue;
+        }
+        // The last reported frame may still be being written
+        int rendered = _processRenderedFrames.value(id) - 1;
+        if (rendered > 0) frames += rendered;
+        break;
+    }
+    return frames;
+}
+
+void AERenderer::processEnded(int processId, bool failed)
+{
+    if (processId == _audioProcessId) return;
+    if (!failed) _completedRanges.insert(processId);
+    // Stopping
+    if (!MediaUtils::isBusy( status() ) || status() == MediaUtils::Cleaning) return;
+
+    // aerender can't render anything, don't launch it for every range
+    if (failed && !_processFirstFrames.contains(processId))
+    {
+        emit newLog( "After Effects failed before rendering any frame, the remaining ranges are cancelled.", LogUtils::Warning );
+        _pendingRanges.clear();
+        return;
+    }
+
+    // Give some more work to this process slot
+    launchNextRange();
+}
+
+bool AERenderer::isUsingTemplates()
 {
     return _setTemplates;
 }
@@ -135,6 +269,13 @@ void AERenderer::setUseTemplates(bool setTemplates)
     _setTemplates = setTemplates;
 }
 
+void AERenderer::restoreTemplates()
+{
+    if (!_templatesSet) return;
+    _templatesSet = false;
+    AfterEffects::instance()->restoreOriginalTemplates();
+}
+
 void AERenderer::readyRead(QString output)
 {
     if (output.trimmed() == "") return;
@@ -143,22 +284,32 @@ void AERenderer::readyRead(QString output)
 
     QRegularExpression reProgress("PROGRESS:\\s*[\\d:]+\\s*\\((\\d+)\\)");
     QRegularExpressionMatch match = reProgress.match(output);
-    if (match.hasMatch())
+    if (match.hasMatch() && outputProcessId() != _audioProcessId)
     {
-        //int currentFrame = match.captured(1).toInt();
-        //Lets get progress from the number of files
-        QFileInfo outputFile(this->outputFileName());
-        QDir outputDir = outputFile.dir();
-        QFileInfoList files = outputDir.entryInfoList(QStringList("*.exr"),QDir::Files);
-        setCurrentFrame( files.count() );
-        //render has started, let's restore original templates
-        AfterEffects::instance()->restoreOriginalTemplates();
+        int frame = match.captured(1).toInt();
+        int id = outputProcessId();
+        if (_rangeArguments.isEmpty())
+        {
+            // All processes render the same frames, skipping existing ones: get the progress from the number of files
+            outputTracker()->update();
+            setCurrentFrame( outputTracker()->numFiles() );
+        }
+        else
+        {
+            // Count the frames rendered by this process
+            if (!_processFirstFrames.contains(id)) _processFirstFrames.insert(id, frame);
+            int rendered = frame - _processFirstFrames.value(id) + 1;
+            _processRenderedFrames.insert(id, rendered);
+            setCurrentFrame( rendered, 0, 0, 0, id );
+        }
+        //render has started, let's restore original templates (unless more ranges have to be launched)
+        if (_pendingRanges.isEmpty()) restoreTemplates();
     }
 
-    //Duration
+    //Duration (of the whole comp; each process only knows the duration of its ranges)
     QRegularExpression reDuration("PROGRESS:\\s*Duration:\\s*(?:(?:(\\d):(\\d\\d):(\\d\\d):(\\d\\d))|(\\d+))");
     match = reDuration.match(output);
-    if (match.hasMatch())
+    if (match.hasMatch() && _rangeArguments.isEmpty())
     {
         if (match.captured(5) == "")
         {
@@ -7,29 +7,46 @@
 
 #include <QObject>
 #include <QRegularExpression>
+#include <QPair>
+#include <QHash>
+#include <QMap>
+#include <QSet>
 
 class AERenderer : public AbstractRenderer
 {
 public:
     /**
-     * @brief Gets the unique AERenderer instance
-     * @return
+     * @brief Constructs a new After Effects renderer. There is one renderer per RenderQueue slot.
+     * @param parent
      */
-    static AERenderer *instance();
+    AERenderer(QObject *parent = nullptr);
 
-    void setUseTemplates(bool isUsingTemplates);
-    bool isUsingTemplates() const;
+    /**
+     * @brief Sets if the renderers have to install the DuME templates before rendering.
+     * This is shared by all renderers, as the templates are installed in the After Effects preferences.
+     * @param isUsingTemplates
+     */
+    static void setUseTemplates(bool isUsingTemplates);
+    static bool isUsingTemplates();
+    /**
+     * @brief Restores the original templates if this renderer has set the DuME ones, and they're not used by another renderer
+     */
+    void restoreTemplates();
+
+    /**
+     * @brief The number of frames completely rendered from the start of the composition, without any missing frame.
+     * While rendering, the frame being written by each process is not counted.
+     * @return The number of frames, 0 if the frames are not rendered in ranges (when using the After Effects render queue)
+     */
+    int completedFrames() const;
 
 protected:
     // reimplementation from AbstractRenderer to handle ae output
     void readyRead(QString output);
+    // reimplementation from AbstractRenderer to launch the next range of frames
+    void processEnded(int processId, bool failed);
 
 private:
-    /**
-     * @brief AERenderer is a singleton, the constructor is private
-     * @param parent
-     */
-    AERenderer(QObject *parent = nullptr);
     /**
      * @brief We need to store the duration in seconds as After Effects uses that instead of frames
      */
@@ -45,15 +62,60 @@ private:
      * @param audio
      */
     void renderAep(MediaInfo *aep, bool audio = false);
+    /**
+     * @brief Splits the frames in contiguous ranges, several per process, so that processes finishing early get more work
+     * @param numFrames The number of frames to render
+     * @param numProcesses The number of processes running at the same time
+     */
+    void splitRanges(int numFrames, int numProcesses);
+    /**
+     * @brief Launches a process for the next range of frames
+     * @return false if all ranges have already been launched
+     */
+    bool launchNextRange();
+    /**
+     * @brief Launches a process for a range of frames
+     */
+    void launchRange(QPair<int, int> range);
+
+    /**
+     * @brief The aerender arguments, without the range of frames
+     */
+    QStringList _rangeArguments;
+    /**
+     * @brief The number of the first frame of the composition, aerender uses the frame numbers displayed in After Effects
+     */
+    int _startFrame;
+    /**
+     * @brief The ranges of frames (first, last) not launched yet, from 0
+     */
+    QList<QPair<int, int>> _pendingRanges;
+    /**
+     * @brief The first progress reported by each process, to count the frames it has rendered
+     */
+    QHash<int, int> _processFirstFrames;
+    /**
+     * @brief The range of each process, the processes by first frame, and the number of frames they've rendered
+     */
+    QHash<int, QPair<int, int>> _processRanges;
+    QMap<int, int> _rangeProcesses;
+    QHash<int, int> _processRenderedFrames;
+    /**
+     * @brief The processes which have successfully rendered their whole range
+     */
+    QSet<int> _completedRanges;
+    /**
+     * @brief The process exporting the audio, which does not count in the progress
+     */
+    int _audioProcessId;
     /**
      * @brief when False, won't try to install dume templates before rendering (if they're set by a script in Ae for example)
      */
-    bool _setTemplates;
-protected:
+    static bool _setTemplates;
     /**
-     * @brief The unique AEREnderer instance
+     * @brief True while this renderer needs the DuME templates
      */
-    static AERenderer *_instance;
+    bool _templatesSet;
 };
 
 #endif // AERENDERER_H
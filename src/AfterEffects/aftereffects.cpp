@@ -12,6 +12,7 @@ AfterEffects *AfterEffects::instance()
 AfterEffects::~AfterEffects()
 {
     //we have to restore templates, just in case...
+    _templateUsers = 0;
     restoreOriginalTemplates();
 }
 
@@ -30,6 +31,8 @@ AfterEffects::AfterEffects(QObject *parent) : AbstractRendererInfo(parent)
 {
     emit newLog("Initializing the After Effects renderer");
 
+    _templateUsers = 0;
+
     //get aerender paths
 
 #ifdef Q_OS_WIN
@@ -149,12 +152,17 @@ bool AfterEffects::setBinary(QString name)
 
 bool AfterEffects::setDuMETemplates()
 {
+    _templateUsers++;
     if ( _currentVersion != nullptr ) return _currentVersion->setDuMETemplates();
     else return false;
 }
 
 void AfterEffects::restoreOriginalTemplates()
 {
+    // Other slots are still rendering with the templates
+    if ( _templateUsers > 0 ) _templateUsers--;
+    if ( _templateUsers > 0 ) return;
+
     if ( _currentVersion != nullptr ) _currentVersion->restoreOriginalTemplates();
 }
 
@@ -37,9 +37,9 @@ public slots:
      * @param name The name of the process to use.
      */
     bool setBinary(QString name);
-    //Sets the DuME Render Templates for After Effects
+    //Sets the DuME Render Templates for After Effects. Each call must be followed by a call to restoreOriginalTemplates()
     bool setDuMETemplates();
-    // Restores the original render templates
+    // Restores the original render templates, once all the renders which have set them don't need them anymore
     void restoreOriginalTemplates();
 
 private:
@@ -61,6 +61,8 @@ private:
     bool _useLatest;
     // The version currently used
     AfterEffectsVersion *_currentVersion;
+    // The number of renders using the DuME templates, which are restored when it gets back to 0
+    int _templateUsers;
 
     // === METHODS ===
 
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui network
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = DuME
@@ -75,11 +75,25 @@ SOURCES += \
     Renderer/abstractrendererinfo.cpp \
     Renderer/audioinfo.cpp \
     Renderer/cachemanager.cpp \
+    Renderer/linesplitter.cpp \
     Renderer/medialist.cpp \
     Renderer/preset.cpp \
     Renderer/presetmanager.cpp \
+    Renderer/probecache.cpp \
+    Renderer/sequencescanner.cpp \
+    Renderer/outputtracker.cpp \
+    Renderer/lutcache.cpp \
+    Renderer/lutbaker.cpp \
+    Renderer/filteroptimizer.cpp \
+    Renderer/framefeeder.cpp \
+    Renderer/batchrunner.cpp \
+    Renderer/jobserver.cpp \
+    Renderer/farmnode.cpp \
+    Renderer/farmcoordinator.cpp \
+    Renderer/probeservice.cpp \
     Renderer/queueitem.cpp \
     Renderer/renderqueue.cpp \
+    Renderer/renderslot.cpp \
     Renderer/streamreference.cpp \
     Renderer/videoinfo.cpp \
     Renderer/mediainfo.cpp \
@@ -112,6 +126,7 @@ SOURCES += \
     UI/outputwidget.cpp \
     UI/queuewidget.cpp \
     UI/streamreferencewidget.cpp \
+    duexr.cpp \
     main.cpp
 
 HEADERS += \
@@ -162,15 +177,30 @@ HEADERS += \
     FFmpeg/ffbaseobject.h \
     FFmpeg/ffmpegrenderer.h \
     FFmpeg/ffcolorprofile.h \
+    FFmpeg/ffobjectindex.h \
     Renderer/abstractrenderer.h \
     Renderer/abstractrendererinfo.h \
     Renderer/audioinfo.h \
     Renderer/cachemanager.h \
+    Renderer/linesplitter.h \
     Renderer/medialist.h \
     Renderer/preset.h \
     Renderer/presetmanager.h \
+    Renderer/probecache.h \
+    Renderer/sequencescanner.h \
+    Renderer/outputtracker.h \
+    Renderer/lutcache.h \
+    Renderer/lutbaker.h \
+    Renderer/filteroptimizer.h \
+    Renderer/framefeeder.h \
+    Renderer/batchrunner.h \
+    Renderer/jobserver.h \
+    Renderer/farmnode.h \
+    Renderer/farmcoordinator.h \
+    Renderer/probeservice.h \
     Renderer/queueitem.h \
     Renderer/renderqueue.h \ 
+    Renderer/renderslot.h \
     Renderer/mediainfo.h \
     Renderer/streamreference.h \
     Renderer/videoinfo.h \
@@ -202,7 +232,8 @@ HEADERS += \
     UI/mainwindow.h \
     UI/outputwidget.h \
     UI/queuewidget.h \
-    UI/streamreferencewidget.h
+    UI/streamreferencewidget.h \
+    duexr.h
 
 FORMS += \
     UI/Blocks/blockcolorinput.ui \
@@ -278,11 +309,16 @@ win* {
 
 
 # OpenImageIO
+# Build with "qmake CONFIG+=oiio" to decode EXR sequences with OpenImageIO instead of ffmpeg
 
-# unix:!macx: LIBS += -lOpenImageIO \
-#    -lOpenImageIO_Util
+oiio {
+    DEFINES += WITH_OIIO
 
-#INCLUDEPATH += /usr/include/OpenImageIO
-#DEPENDPATH += /usr/include/OpenImageIO
+    unix:!macx: LIBS += -lOpenImageIO \
+        -lOpenImageIO_Util
+
+    INCLUDEPATH += /usr/include/OpenImageIO
+    DEPENDPATH += /usr/include/OpenImageIO
+}
 
 DISTFILES +=
@@ -40,12 +40,12 @@ void FFLut::setInputProfile(const QString &inputProfile)
 
 QString FFLut::extract()
 {
-    //extract LUT
-    CacheManager *cm = CacheManager::instance();
-    QDir d = cm->getRootCacheDir();
     if (!_name.startsWith(":/")) return _name;
-    QFileInfo sourceInfo(_name);
-    QString destinationLutPath = d.absolutePath() + "/" + sourceInfo.fileName();
-    QFile::copy(_name, destinationLutPath);
-    return destinationLutPath;
+    //extract LUT, once per session
+    return LutCache::instance()->lut(_name).path;
+}
+
+LutInfo FFLut::info()
+{
+    return LutCache::instance()->lut(_name);
 }
@@ -2,7 +2,7 @@
 #define FFLUT_H
 
 #include "ffbaseobject.h"
-#include "Renderer/cachemanager.h"
+#include "Renderer/lutcache.h"
 
 class FFLut : public FFBaseObject
 {
@@ -21,7 +21,16 @@ public:
     QString inputProfile() const;
     void setInputProfile(const QString &inputProfile);
 
+    /**
+     * @brief Extracts the LUT from the resources if needed
+     * @return The path of the LUT file
+     */
     QString extract();
+    /**
+     * @brief The description of the LUT (dimension, size...), read only once per session
+     * @return
+     */
+    LutInfo info();
 
 private:
     QString _inputProfile;
@@ -7,6 +7,9 @@
 FFmpeg::FFmpeg(QString path,QObject *parent) : AbstractRendererInfo(parent)
 {
     _status = MediaUtils::Initializing;
+    _ffprobeBinary = "";
+    _loadingMuxerDetails = false;
+    _muxerExtensionsChanged = true;
 
     // Defaults
     _defaultPixFormat = FFPixFormat::getDefault( this );
@@ -233,6 +236,11 @@ FFmpeg::FFmpeg(QString path,QObject *parent) : AbstractRendererInfo(parent)
     _colorSpaces << m;
 
     // The complete color Profiles
+    _colorTRCsIndex.index( _colorTRCs );
+    _colorPrimariesIndex.index( _colorPrimaries );
+    _colorSpacesIndex.index( _colorSpaces );
+    _colorRangesIndex.index( _colorRanges );
+
     _colorProfiles << new FFColorProfile("", "Auto", colorPrimary(""), colorTRC(""), colorSpace(""), colorRange(""));
     _colorProfiles << new FFColorProfile("input", "Same as input", colorPrimary("input"), colorTRC("input"), colorSpace("input"), colorRange("input"));
     _colorProfiles << new FFColorProfile("srgb", "Images (sRGB)", colorPrimary("bt709"), colorTRC("iec61966_2_1"), colorSpace("rgb"), colorRange("pc"));
@@ -246,6 +254,7 @@ FFmpeg::FFmpeg(QString path,QObject *parent) : AbstractRendererInfo(parent)
     _colorProfiles << new FFColorProfile("palsecam", "PAL / SECAM", colorPrimary("bt470bg"), colorTRC("gamma22"), colorSpace("bt470bg"), colorRange("tv"));
     _colorProfiles << new FFColorProfile("ntsc", "NTSC", colorPrimary("smpte170m"), colorTRC("smpte170m"), colorSpace("smpte170m"), colorRange("tv"));
     _colorProfiles << new FFColorProfile("qt196", "QT 709 gamma 1.96", colorPrimary("bt709"), colorTRC("qt196"), colorSpace("bt709"), colorRange("tv"));
+    _colorProfilesIndex.index( _colorProfiles );
 
     // The LUTs
     _luts << new FFLut( "", "None");
@@ -261,6 +270,7 @@ FFmpeg::FFmpeg(QString path,QObject *parent) : AbstractRendererInfo(parent)
     _luts << new FFLut(  ":/luts/adobe-to-qt.cube", "Set QT Gamma 1.96 (Adobe LUT)", "bt709", "qt196", FFLut::OneD);
     _luts << new FFLut(  ":/luts/qt-to-adobe.cube", "Undo QT Gamma 1.96 (Adobe LUT)", "qt196", "bt709", FFLut::OneD);
     _luts << new FFLut( "custom", "Custom...");
+    _lutsIndex.index( _luts );
 
     //The motion interpolation algorithms
     _motionInterpolationAlgorithms << new FFBaseObject("","Default (epzs)");
@@ -316,6 +326,8 @@ bool FFmpeg::setBinary(QString path, bool initialize)
     if ( AbstractRendererInfo::setBinary(path) )
     {
         settings.setValue("ffmpeg/path", path );
+        _ffprobeBinary = findFFprobe(path);
+        if (_ffprobeBinary != "") qDebug() << "Using ffprobe to analyse media: " + _ffprobeBinary;
         if (initialize) init();
         emit binaryChanged( path );
         qDebug() << "New FFmpeg path correctly set: " + path;
@@ -389,7 +401,7 @@ void FFmpeg::init()
     emit newLog( "Loading Muxers" );
     if (runCommand( "-hide_banner -formats" , 10000))
     {
-        gotMuxers( _output, newVersion );
+        gotMuxers( _output );
     }
 
     //get long help
@@ -457,16 +469,7 @@ QList<FFLut *> FFmpeg::luts() const
 
 FFLut *FFmpeg::lut(QString name)
 {
-    name = name.trimmed();
-    foreach(FFLut *l, _luts)
-    {
-        if (l->name().toLower() == name.trimmed().toLower()) return l;
-    }
-    foreach(FFLut *l, _luts)
-    {
-        if (l->prettyName() == name) return l;
-    }
-    return _luts[0];
+    return _lutsIndex.value( name, _luts[0] );
 }
 
 QList<FFMuxer *> FFmpeg::muxers(bool encodeOnly)
@@ -477,28 +480,49 @@ QList<FFMuxer *> FFmpeg::muxers(bool encodeOnly)
 
 FFMuxer *FFmpeg::muxer(QString nameOrExtension)
 {
-    foreach(FFMuxer *muxer,_muxers)
+    if (nameOrExtension.trimmed() == "") return _defaultMuxer;
+
+    FFMuxer *m = _muxersIndex.value( nameOrExtension );
+    if (m)
     {
-        if (muxer->name().toLower() == nameOrExtension.trimmed().toLower())
-        {
-            return muxer;
-        }
+        loadMuxerDetails(m);
+        return m;
     }
-    foreach(FFMuxer *muxer,_muxers)
+
+    m = muxerByExtension( nameOrExtension );
+    if (m) return m;
+
+    // The extensions are not known until the details are loaded
+    if (_loadingMuxerDetails)
     {
-        if (muxer->prettyName() == nameOrExtension)
-        {
-            return muxer;
-        }
+        loadAllMuxerDetails();
+        m = muxerByExtension( nameOrExtension );
+        if (m) return m;
     }
-    foreach(FFMuxer *muxer,_muxers)
+    return _defaultMuxer;
+}
+
+FFMuxer *FFmpeg::muxerByExtension(QString extension)
+{
+    // Extensions change when the muxer details are loaded
+    if (_muxerExtensionsChanged)
     {
-        if (muxer->extensions().contains(nameOrExtension))
+        _muxerExtensions.clear();
+        foreach(FFMuxer *m, _muxers)
         {
-            return muxer;
+            foreach(QString ext, m->extensions())
+            {
+                if (!_muxerExtensions.contains(ext)) _muxerExtensions.insert(ext, m);
+            }
         }
+        _muxerExtensionsChanged = false;
     }
-    return _defaultMuxer;
+    return _muxerExtensions.value(extension, nullptr);
+}
+
+bool FFmpeg::isLoadingMuxers() const
+{
+    return _loadingMuxerDetails;
 }
 
 FFCodec *FFmpeg::muxerDefaultCodec(FFMuxer *muxer, FFCodec::Ability ability)
@@ -538,155 +562,57 @@ QList<FFCodec *> FFmpeg::audioEncoders()
 
 FFCodec *FFmpeg::videoEncoder(QString name)
 {
-    foreach(FFCodec *codec,_videoEncoders)
-    {
-        if (codec->name().toLower() == name.trimmed().toLower()) return codec;
-    }
-    foreach(FFCodec *codec,_videoEncoders)
-    {
-        if (codec->prettyName() == name) return codec;
-    }
-    return _defaultCodec;
+    return _videoEncodersIndex.value( name, _defaultCodec );
 }
 
 FFCodec *FFmpeg::audioEncoder(QString name)
 {
-    name = name.trimmed();
-    foreach(FFCodec *codec,_audioEncoders)
-    {
-        if (codec->name().toLower() == name.trimmed().toLower()) return codec;
-    }
-    foreach(FFCodec *codec,_audioEncoders)
-    {
-        if (codec->prettyName() == name) return codec;
-    }
-    return _defaultCodec;
+    return _audioEncodersIndex.value( name, _defaultCodec );
 }
 
 FFCodec *FFmpeg::videoDecoder(QString name)
 {
-    name = name.trimmed();
-    foreach(FFCodec *codec,_videoDecoders)
-    {
-        if (codec->name().toLower() == name.trimmed().toLower()) return codec;
-    }
-    foreach(FFCodec *codec,_videoDecoders)
-    {
-        if (codec->prettyName() == name) return codec;
-    }
-    return _defaultCodec;
+    return _videoDecodersIndex.value( name, _defaultCodec );
 }
 
 FFCodec *FFmpeg::audioDecoder(QString name)
 {
-    name = name.trimmed();
-    foreach(FFCodec *codec,_audioDecoders)
-    {
-        if (codec->name().toLower() == name.trimmed().toLower()) return codec;
-    }
-    foreach(FFCodec *codec,_audioDecoders)
-    {
-        if (codec->prettyName() == name) return codec;
-    }
-    return _defaultCodec;
+    return _audioDecodersIndex.value( name, _defaultCodec );
 }
 
 FFPixFormat *FFmpeg::pixFormat(QString name)
 {
-    name = name.trimmed();
-    foreach(FFPixFormat *pf,_pixFormats)
-    {
-        if (pf->name().toLower() == name.toLower()) return pf;
-    }
-    foreach(FFPixFormat *pf,_pixFormats)
-    {
-        if (pf->prettyName() == name) return pf;
-    }
-    return _defaultPixFormat;
+    return _pixFormatsIndex.value( name, _defaultPixFormat );
 }
 
 FFSampleFormat *FFmpeg::sampleFormat(QString name)
 {
-    name = name.trimmed();
-    foreach(FFSampleFormat *sf, _sampleFormats)
-    {
-        if (sf->name().toLower() == name.toLower()) return sf;
-    }
-    foreach(FFSampleFormat *sf, _sampleFormats)
-    {
-        if (sf->prettyName() == name) return sf;
-    }
-    return _defaultSampleFormat;
+    return _sampleFormatsIndex.value( name, _defaultSampleFormat );
 }
 
 FFColorItem *FFmpeg::colorTRC(QString name)
 {
-    name = name.trimmed();
-    foreach(FFColorItem *c,_colorTRCs)
-    {
-        if (c->name().toLower() == name.trimmed().toLower()) return c;
-    }
-    foreach(FFColorItem *c,_colorTRCs)
-    {
-        if (c->prettyName() == name) return c;
-    }
-    return _colorTRCs[0];
+    return _colorTRCsIndex.value( name, _colorTRCs[0] );
 }
 
 FFColorItem *FFmpeg::colorPrimary(QString name)
 {
-    name = name.trimmed();
-    foreach(FFColorItem *c,_colorPrimaries)
-    {
-        if (c->name().toLower() == name.trimmed().toLower()) return c;
-    }
-    foreach(FFColorItem *c,_colorPrimaries)
-    {
-        if (c->prettyName() == name) return c;
-    }
-    return _colorPrimaries[0];
+    return _colorPrimariesIndex.value( name, _colorPrimaries[0] );
 }
 
 FFColorItem *FFmpeg::colorSpace(QString name)
 {
-    name = name.trimmed();
-    foreach(FFColorItem *c,_colorSpaces)
-    {
-        if (c->name().toLower() == name.trimmed().toLower()) return c;
-    }
-    foreach(FFColorItem *c,_colorSpaces)
-    {
-        if (c->prettyName() == name) return c;
-    }
-    return _colorSpaces[0];
+    return _colorSpacesIndex.value( name, _colorSpaces[0] );
 }
 
 FFColorItem *FFmpeg::colorRange(QString name)
 {
-    name = name.trimmed();
-    foreach(FFColorItem *c,_colorRanges)
-    {
-        if (c->name().toLower() == name.trimmed().toLower()) return c;
-    }
-    foreach(FFColorItem *c,_colorRanges)
-    {
-        if (c->prettyName() == name) return c;
-    }
-    return _colorRanges[0];
+    return _colorRangesIndex.value( name, _colorRanges[0] );
 }
 
 FFColorProfile *FFmpeg::colorProfile(QString name)
 {
-    name = name.trimmed();
-    foreach(FFColorProfile *c,_colorProfiles)
-    {
-        if (c->name().toLower() == name.trimmed().toLower()) return c;
-    }
-    foreach(FFColorProfile *c,_colorProfiles)
-    {
-        if (c->prettyName() == name) return c;
-    }
-    return _colorProfiles[0];
+    return _colorProfilesIndex.value( name, _colorProfiles[0] );
 }
 
 FFColorProfile *FFmpeg::colorProfile(FFColorItem *primaries, FFColorItem *trc, FFColorItem *space, FFColorItem *range, QObject *parent)
@@ -770,12 +696,78 @@ QString FFmpeg::longHelp()
 
 QString FFmpeg::analyseMedia(QString mediaPath)
 {
-    QStringList args("-hide_banner");
-    args << "-i" << QDir::toNativeSeparators(mediaPath);
-    if ( runCommand( args, 3000) )
+    // Files which have already been analysed are in the cache
+    QFileInfo mediaFile(mediaPath);
+    QString probe = ProbeCache::instance()->probe( mediaFile, probeVersion() );
+    if (probe != "") return probe;
+
+    if ( hasFFprobe() )
     {
-        return _output;
+        // ffprobe prints its JSON on stdout, ignore the logs
+        QProcess ffprobe;
+        ffprobe.start( _ffprobeBinary, probeArguments(mediaPath), QIODevice::ReadOnly );
+        if ( !ffprobe.waitForFinished(3000) )
+        {
+            ffprobe.kill();
+            return "";
+        }
+        probe = QString::fromUtf8( ffprobe.readAllStandardOutput() );
+    }
+    else if ( runCommand( probeArguments(mediaPath), 3000) )
+    {
+        probe = _output;
     }
+
+    // Only keep successful analysis
+    if (isValidProbe(probe)) ProbeCache::instance()->insert( mediaFile, probeVersion(), probe );
+    return probe;
+}
+
+QString FFmpeg::probeBinary() const
+{
+    if ( hasFFprobe() ) return _ffprobeBinary;
+    return binary();
+}
+
+QStringList FFmpeg::probeArguments(QString mediaPath) const
+{
+    QStringList args;
+    if ( hasFFprobe() ) args << "-v" << "quiet" << "-print_format" << "json" << "-show_streams" << "-show_format";
+    else args << "-hide_banner" << "-i";
+    args << QDir::toNativeSeparators(mediaPath);
+    return args;
+}
+
+QString FFmpeg::probeVersion() const
+{
+    if ( hasFFprobe() ) return "ffprobe " + _version;
+    return "ffmpeg " + _version;
+}
+
+bool FFmpeg::isValidProbe(QString probe) const
+{
+    if ( probe.startsWith("{") ) return QJsonDocument::fromJson( probe.toUtf8() ).object().contains("format");
+    return probe.contains("Input #");
+}
+
+bool FFmpeg::hasFFprobe() const
+{
+    if (_ffprobeBinary == "") return false;
+    return QSettings().value("ffmpeg/useFFprobe", true).toBool();
+}
+
+QString FFmpeg::findFFprobe(QString ffmpegPath) const
+{
+    // ffprobe is shipped along with ffmpeg, with the same name (dume-ffprobe, ffprobe.exe...)
+    QFileInfo ffmpegFile(ffmpegPath);
+    QString probeName = ffmpegFile.fileName().replace("ffmpeg", "ffprobe");
+    if (probeName == ffmpegFile.fileName()) return "";
+
+    // System command
+    if (!ffmpegPath.contains("/") && !ffmpegPath.contains("\\")) return QStandardPaths::findExecutable( probeName );
+
+    QString probePath = ffmpegFile.dir().filePath( probeName );
+    if (QFileInfo::exists(probePath)) return probePath;
     return "";
 }
 
@@ -807,155 +799,68 @@ bool muxerSorter(FFMuxer *m1,FFMuxer *m2)
     return m1->extensions()[0] < m2->extensions()[0];
 }
 
-void FFmpeg::gotMuxers(QString output, QString newVersion)
+void FFmpeg::gotMuxers(QString output)
 {
     QSettings settings;
+    // Forget the details being loaded for the previous muxers
+    cancelMuxerDetails();
     //delete all
     qDeleteAll(_muxers);
     _muxers.clear();
     _decodeMuxers.clear();
     _encodeMuxers.clear();
+    _muxersIndex.clear();
+    _muxerExtensions.clear();
+    _muxerExtensionsChanged = true;
 
-    //if the version is the same as previously, just read data from settings
-    if (newVersion == _version)
-    {
-        emit newLog("Getting muxers from stored list.");
+    // Previous versions stored the muxers in the settings
+    settings.remove("ffmpeg/muxers");
 
-        //open array
-        int arraySize = settings.beginReadArray("ffmpeg/muxers");
+    emit newLog("Loading muxers list...");
 
-        _progressMax = _prevMax + arraySize; //pixfmts + codecs + muxers
-        emit progressMax( _progressMax );
+    QStringList muxers = output.split("\n");
+    QRegularExpression re("[D. ]E (\\w+)\\s+(.+)");
 
-        for (int i = 0; i < arraySize; i++)
-        {
-            settings.setArrayIndex(i);
+    int max = muxers.count();
+    _progressMax = _prevMax + max; //pixfmts + codecs + muxers
+    emit progressMax( _progressMax );
 
-            emit progress( _prevMax + i);
+    for (int i = 0 ; i < muxers.count() ; i++)
+    {
+        QString muxer = muxers[i];
+        emit progress(_prevMax + i);
 
-            QString name = settings.value("name").toString();
-            QString prettyName = settings.value("prettyName").toString();
+        QRegularExpressionMatch match = re.match(muxer);
+        if (match.hasMatch())
+        {
+            QString name = match.captured(1).trimmed();
+            QString prettyName = match.captured(2).trimmed();
+
+#ifdef FFMPEG_VERBOSE_DEBUG
+            emit newLog("Loading muxer: " + name);
+#endif
 
-            //emit newLog("Loading muxer:" + name);
-            if (name == "") continue;
+            // skip image sequence
+            if (name == "image2") continue;
 
             FFMuxer *m = new FFMuxer(name,prettyName,this);
             _muxers << m;
             _decodeMuxers << m;
             _encodeMuxers << m;
-
-            //get default codecs
-            QString defltVideoCodec = settings.value("defaultVideoCodec").toString();
-            m->setDefaultVideoCodec(videoEncoder( defltVideoCodec ));
-
-            QString defltAudioCodec = settings.value("defaultAudioCodec").toString();
-            m->setDefaultAudioCodec(audioEncoder( defltAudioCodec ));
-
-            QString extensions = settings.value("extensions").toString();
-            QStringList extensionsList = extensions.split(",");
-            if (extensionsList[0] != "") m->setExtensions(extensionsList);
+            // The details (default codecs, extensions) are loaded later
+            _muxersToLoad << m;
         }
-
-        settings.endArray();
-
-        _prevMax = _prevMax + arraySize;
     }
 
-    //if the version has changed, or if we did not get the list from settings
-    if (newVersion != _version || _muxers.count() == 0)
-    {
-        emit newLog("Updating muxers list...");
-
-        QStringList muxers = output.split("\n");
-        QRegularExpression re("[D. ]E (\\w+)\\s+(.+)");
-
-        int max = muxers.count();
-        _progressMax = _prevMax + max; //pixfmts + codecs + muxers
-        emit progressMax( _progressMax );
-
-        //remove the previous codecs
-        settings.remove("ffmpeg/muxers");
-        //create the new array
-        settings.beginWriteArray("ffmpeg/muxers");
-        int n = -1;
-
-        for (int i = 0 ; i < muxers.count() ; i++)
-        {
-            if (i%10 == 0) QCoreApplication::processEvents();
-            QString muxer = muxers[i];
-            emit progress(_prevMax + i);
-
-            QRegularExpressionMatch match = re.match(muxer);
-            if (match.hasMatch())
-            {
-                QString name = match.captured(1).trimmed();
-                QString prettyName = match.captured(2).trimmed();
-
-#ifdef FFMPEG_VERBOSE_DEBUG
-                emit newLog("Loading muxer: " + name);
-#endif
-
-                // skip image sequence
-                if (name == "image2") continue;
-
-                FFMuxer *m = new FFMuxer(name,prettyName,this);
-                _muxers << m;
-                _decodeMuxers << m;
-                _encodeMuxers << m;
-
-                //save to settings
-                n++;
-                settings.setArrayIndex( n );
-                settings.setValue("name", name);
-                settings.setValue("prettyName", prettyName);
-
-                //get default codecs
-                QStringList args("-hide_banner");
-                args << "-h";
-                args << "muxer=" + m->name();
-                if (runCommand(args,3000))
-                {
-                    QStringList lines = _output.split("\n");
-
-                    QRegularExpression reVideo("Default video codec:\\s*(.+)\\.");
-                    QRegularExpression reAudio("Default audio codec:\\s*(.+)\\.");
-                    QRegularExpression reExtensions("Common extensions:\\s*(.+)\\.");
-
-                    foreach(QString line,lines)
-                    {
-                        //video codec
-                        QRegularExpressionMatch videoMatch = reVideo.match(line);
-                        if (videoMatch.hasMatch())
-                        {
-                            QString defltVideoCodec = videoMatch.captured(1);
-                            m->setDefaultVideoCodec(videoEncoder( defltVideoCodec ));
-                            settings.setValue("defaultVideoCodec", defltVideoCodec );
-                        }
-
-                        //audio codec
-                        QRegularExpressionMatch audioMatch = reAudio.match(line);
-                        if (audioMatch.hasMatch())
-                        {
-                            QString defltAudioCodec = audioMatch.captured(1);
-                            m->setDefaultAudioCodec(audioEncoder( defltAudioCodec ));
-                            settings.setValue("defaultAudioCodec", defltAudioCodec );
-                        }
-
-                        //extensions
-                        QRegularExpressionMatch extensionsMatch = reExtensions.match(line);
-                        if (extensionsMatch.hasMatch())
-                        {
-                            QString extensions = extensionsMatch.captured(1);
-                            m->setExtensions(extensions.split(","));
-                            settings.setValue("extensions", extensions );
-                        }
-                    }
-                }
-            }
-        }
+    _prevMax = _prevMax + max;
 
-        settings.endArray();
-        _prevMax = _prevMax + max;
+    // Get the details from the capabilities cache, or load them in the background
+    readCapabilitiesCache();
+    if (_muxersToLoad.count() > 0)
+    {
+        emit newLog("Loading muxer details in the background...");
+        _loadingMuxerDetails = true;
+        launchMuxerDetails();
     }
 
     //add image sequences
@@ -1120,6 +1025,254 @@ void FFmpeg::gotMuxers(QString output, QString newVersion)
     std::sort(_muxers.begin(),_muxers.end(),muxerSorter);
     std::sort(_decodeMuxers.begin(),_decodeMuxers.end(),muxerSorter);
     std::sort(_encodeMuxers.begin(),_encodeMuxers.end(),muxerSorter);
+
+    _muxersIndex.index( _muxers );
+    _muxerExtensionsChanged = true;
+}
+
+bool FFmpeg::gotMuxerDetails(FFMuxer *muxer, QString output)
+{
+    // ffmpeg failed or does not know this muxer
+    if (!output.contains("Muxer " + muxer->name()))
+    {
+        _failedMuxerDetails << muxer;
+        return false;
+    }
+
+    QStringList lines = output.split("\n");
+
+    QRegularExpression reVideo("Default video codec:\\s*(.+)\\.");
+    QRegularExpression reAudio("Default audio codec:\\s*(.+)\\.");
+    QRegularExpression reExtensions("Common extensions:\\s*(.+)\\.");
+
+    foreach(QString line,lines)
+    {
+        //video codec
+        QRegularExpressionMatch videoMatch = reVideo.match(line);
+        if (videoMatch.hasMatch())
+        {
+            muxer->setDefaultVideoCodec(videoEncoder( videoMatch.captured(1) ));
+        }
+
+        //audio codec
+        QRegularExpressionMatch audioMatch = reAudio.match(line);
+        if (audioMatch.hasMatch())
+        {
+            muxer->setDefaultAudioCodec(audioEncoder( audioMatch.captured(1) ));
+        }
+
+        //extensions
+        QRegularExpressionMatch extensionsMatch = reExtensions.match(line);
+        if (extensionsMatch.hasMatch())
+        {
+            muxer->setExtensions(extensionsMatch.captured(1).split(","));
+            _muxerExtensionsChanged = true;
+        }
+    }
+
+    return true;
+}
+
+void FFmpeg::loadMuxerDetails(FFMuxer *muxer)
+{
+    // Being loaded in the background, just wait for it (finished is emitted while waiting)
+    QProcess *process = _muxerDetailsProcesses.key(muxer, nullptr);
+    if (process)
+    {
+        process->waitForFinished(3000);
+        return;
+    }
+
+    // Already loaded
+    if (!_muxersToLoad.removeOne(muxer)) return;
+
+    QStringList args("-hide_banner");
+    args << "-h" << "muxer=" + muxer->name();
+    if (runCommand(args, 3000)) gotMuxerDetails(muxer, _output);
+    else _failedMuxerDetails << muxer;
+
+    checkMuxerDetails();
+}
+
+void FFmpeg::loadAllMuxerDetails()
+{
+    while (!_muxersToLoad.isEmpty()) loadMuxerDetails(_muxersToLoad.first());
+    foreach(QProcess *process, _muxerDetailsProcesses.keys()) process->waitForFinished(3000);
+}
+
+void FFmpeg::launchMuxerDetails()
+{
+    int maxProcesses = QThread::idealThreadCount();
+    if (maxProcesses < 1) maxProcesses = 1;
+
+    while (!_muxersToLoad.isEmpty() && _muxerDetailsProcesses.count() < maxProcesses)
+    {
+        FFMuxer *m = _muxersToLoad.takeFirst();
+
+        QProcess *process = new QProcess(this);
+        process->setProcessChannelMode(QProcess::MergedChannels);
+        connect(process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(muxerDetailsFinished()));
+        connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(muxerDetailsError(QProcess::ProcessError)));
+        _muxerDetailsProcesses.insert(process, m);
+
+        QStringList args("-hide_banner");
+        args << "-h" << "muxer=" + m->name();
+        process->start(binary(), args, QIODevice::ReadOnly);
+    }
+
+    checkMuxerDetails();
+}
+
+void FFmpeg::cancelMuxerDetails()
+{
+    foreach(QProcess *process, _muxerDetailsProcesses.keys())
+    {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+    _muxerDetailsProcesses.clear();
+    _muxersToLoad.clear();
+    _failedMuxerDetails.clear();
+    _loadingMuxerDetails = false;
+}
+
+void FFmpeg::checkMuxerDetails()
+{
+    if (!_loadingMuxerDetails) return;
+    if (!_muxersToLoad.isEmpty() || !_muxerDetailsProcesses.isEmpty()) return;
+
+    _loadingMuxerDetails = false;
+
+    // The extensions have changed
+    std::sort(_muxers.begin(),_muxers.end(),muxerSorter);
+    std::sort(_decodeMuxers.begin(),_decodeMuxers.end(),muxerSorter);
+    std::sort(_encodeMuxers.begin(),_encodeMuxers.end(),muxerSorter);
+    _muxersIndex.index( _muxers );
+
+    writeCapabilitiesCache();
+    emit newLog("Muxer details loaded.");
+    emit muxersLoaded();
+}
+
+void FFmpeg::muxerDetailsFinished()
+{
+    QProcess *process = qobject_cast<QProcess*>( sender() );
+    if (!process) return;
+
+    FFMuxer *m = _muxerDetailsProcesses.take(process);
+    if (m && process->exitStatus() == QProcess::NormalExit && process->exitCode() == 0) gotMuxerDetails(m, QString::fromUtf8( process->readAllStandardOutput() ));
+    else if (m) _failedMuxerDetails << m;
+    process->deleteLater();
+
+    launchMuxerDetails();
+}
+
+void FFmpeg::muxerDetailsError(QProcess::ProcessError e)
+{
+    // Other errors are followed by the finished signal
+    if (e != QProcess::FailedToStart) return;
+    QProcess *process = qobject_cast<QProcess*>( sender() );
+    if (!process) return;
+
+    FFMuxer *m = _muxerDetailsProcesses.take(process);
+    if (m) _failedMuxerDetails << m;
+    process->deleteLater();
+
+    launchMuxerDetails();
+}
+
+QString FFmpeg::binaryHash()
+{
+    QSettings settings;
+
+    QFileInfo binaryFile( binary() );
+    // System command
+    if (!binaryFile.exists()) binaryFile = QFileInfo( QStandardPaths::findExecutable( binary() ) );
+    if (!binaryFile.exists()) return "";
+
+    // Hashing the binary takes some time, do it again only if the file has changed
+    QString stamp = binaryFile.absoluteFilePath() + "|" + QString::number( binaryFile.size() ) + "|" + QString::number( binaryFile.lastModified().toMSecsSinceEpoch() );
+    QString hash = settings.value("ffmpeg/binaryHash", "").toString();
+    if (hash != "" && settings.value("ffmpeg/binaryStamp", "").toString() == stamp) return hash;
+
+    QFile f( binaryFile.absoluteFilePath() );
+    if (!f.open(QIODevice::ReadOnly)) return "";
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(&f);
+    f.close();
+    hash = h.result().toHex();
+
+    settings.setValue("ffmpeg/binaryStamp", stamp);
+    settings.setValue("ffmpeg/binaryHash", hash);
+    return hash;
+}
+
+QString FFmpeg::capabilitiesCachePath()
+{
+    QString hash = binaryHash();
+    if (hash == "") return "";
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/ffmpeg/" + hash + ".json";
+}
+
+void FFmpeg::readCapabilitiesCache()
+{
+    QFile cacheFile( capabilitiesCachePath() );
+    if (!cacheFile.open(QIODevice::ReadOnly)) return;
+    QJsonObject cachedMuxers = QJsonDocument::fromJson( cacheFile.readAll() ).object().value("muxers").toObject();
+    cacheFile.close();
+
+    emit newLog("Getting muxer details from the cache.");
+
+    QList<FFMuxer *> muxers = _muxersToLoad;
+    foreach(FFMuxer *m, muxers)
+    {
+        if (!cachedMuxers.contains(m->name())) continue;
+        QJsonObject details = cachedMuxers.value(m->name()).toObject();
+
+        m->setDefaultVideoCodec(videoEncoder( details.value("defaultVideoCodec").toString() ));
+        m->setDefaultAudioCodec(audioEncoder( details.value("defaultAudioCodec").toString() ));
+        QStringList extensions;
+        foreach(QJsonValue ext, details.value("extensions").toArray()) extensions << ext.toString();
+        if (extensions.count() > 0)
+        {
+            m->setExtensions(extensions);
+            _muxerExtensionsChanged = true;
+        }
+
+        _muxersToLoad.removeOne(m);
+    }
+}
+
+void FFmpeg::writeCapabilitiesCache()
+{
+    QString cachePath = capabilitiesCachePath();
+    if (cachePath == "") return;
+    QDir().mkpath( QFileInfo(cachePath).path() );
+
+    QJsonObject cachedMuxers;
+    foreach(FFMuxer *m, _encodeMuxers)
+    {
+        // Image sequences are built-in
+        if (m->isSequence()) continue;
+        // Try again next time
+        if (_failedMuxerDetails.contains(m)) continue;
+
+        QJsonObject details;
+        details.insert("defaultVideoCodec", m->defaultVideoCodec()->name());
+        details.insert("defaultAudioCodec", m->defaultAudioCodec()->name());
+        details.insert("extensions", QJsonArray::fromStringList( m->extensions() ));
+        cachedMuxers.insert(m->name(), details);
+    }
+
+    QJsonObject cache;
+    cache.insert("version", _version);
+    cache.insert("muxers", cachedMuxers);
+
+    QSaveFile cacheFile( cachePath );
+    if (!cacheFile.open(QIODevice::WriteOnly)) return;
+    cacheFile.write( QJsonDocument(cache).toJson(QJsonDocument::Compact) );
+    cacheFile.commit();
 }
 
 bool ffSorter(FFBaseObject *c1,FFBaseObject *c2)
@@ -1378,6 +1531,11 @@ void FFmpeg::gotCodecs(QString output, QString newVersion )
     emit newLog("Sorting Codecs...");
     std::sort(_videoEncoders.begin(),_videoEncoders.end(),ffSorter);
     std::sort(_audioEncoders.begin(),_audioEncoders.end(),ffSorter);
+
+    _videoEncodersIndex.index( _videoEncoders );
+    _audioEncodersIndex.index( _audioEncoders );
+    _videoDecodersIndex.index( _videoDecoders );
+    _audioDecodersIndex.index( _audioDecoders );
 }
 
 void FFmpeg::gotPixFormats(QString output, QString newVersion)
@@ -1500,6 +1658,8 @@ void FFmpeg::gotPixFormats(QString output, QString newVersion)
 
     emit newLog("Sorting pixel formats...");
     std::sort(_pixFormats.begin(),_pixFormats.end(),ffSorter);
+
+    _pixFormatsIndex.index( _pixFormats );
 }
 
 void FFmpeg::gotSampleFormats(QString output, QString newVersion)
@@ -1579,6 +1739,8 @@ void FFmpeg::gotSampleFormats(QString output, QString newVersion)
 
     emit newLog("Sorting sample formats...");
     std::sort(_sampleFormats.begin(),_sampleFormats.end(),ffSorter);
+
+    _sampleFormatsIndex.index( _sampleFormats );
 }
 
 FFmpeg *FFmpeg::_instance = nullptr;
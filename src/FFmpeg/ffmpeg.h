@@ -9,10 +9,21 @@
 #include <QDir>
 #include <QtDebug>
 #include <QCoreApplication>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QThread>
+#include <QHash>
+#include <QDateTime>
 
 #include "duqf-utils/utils.h"
 
 #include "Renderer/abstractrendererinfo.h"
+#include "Renderer/probecache.h"
 
 #include "ffcodec.h"
 #include "ffmuxer.h"
@@ -21,6 +32,7 @@
 #include "ffsampleformat.h"
 #include "ffcoloritem.h"
 #include "fflut.h"
+#include "ffobjectindex.h"
 
 class FFmpeg : public AbstractRendererInfo
 {
@@ -43,6 +55,11 @@ public:
      * @return
      */
     FFMuxer *muxer(QString nameOrExtension);
+    /**
+     * @brief Checks if the muxer details (default codecs, extensions) are still being loaded in the background
+     * @return
+     */
+    bool isLoadingMuxers() const;
     /**
      * @brief getMuxerDefaultCodec Checks what is the default codec for this muxer
      * @param muxer
@@ -158,6 +175,33 @@ public:
      * @return The information returned by FFmpeg
      */
     QString analyseMedia(QString mediaPath);
+    /**
+     * @brief The binary used to analyse media: ffprobe if it is available, ffmpeg otherwise
+     * @return
+     */
+    QString probeBinary() const;
+    /**
+     * @brief Checks if ffprobe has been found along with ffmpeg and can be used to analyse media
+     * @return
+     */
+    bool hasFFprobe() const;
+    /**
+     * @brief The arguments to pass to the binary to analyse a media
+     * @param mediaPath The path to the media file
+     * @return The arguments
+     */
+    QStringList probeArguments(QString mediaPath) const;
+    /**
+     * @brief The name and version of the prober, used to identify the analysis in the ProbeCache
+     * @return
+     */
+    QString probeVersion() const;
+    /**
+     * @brief Checks if the output of the prober is a successful analysis
+     * @param probe The analysis
+     * @return
+     */
+    bool isValidProbe(QString probe) const;
     /**
      * @brief getVersion Gets the current ffmpeg version
      * @return
@@ -175,6 +219,10 @@ public:
 signals:
     void progress(int);
     void progressMax(int);
+    /**
+     * @brief Emitted when the details of all the muxers have been loaded in the background
+     */
+    void muxersLoaded();
 
 public slots:
     /**
@@ -185,6 +233,10 @@ public slots:
     bool setBinary(QString path, bool initialize = true);
     void init();
 
+private slots:
+    void muxerDetailsFinished();
+    void muxerDetailsError(QProcess::ProcessError e);
+
 private:
 
     /**
@@ -197,6 +249,8 @@ private:
     // === ATTRIBUTES ===
     // The ffmpeg version
     QString _version;
+    // The ffprobe binary shipped with ffmpeg, empty if not found
+    QString _ffprobeBinary;
 
     // The list of video encoders
     QList<FFCodec *> _videoEncoders;
@@ -214,6 +268,13 @@ private:
     QList<FFMuxer *> _muxers;
     // The default muxer
     FFMuxer *_defaultMuxer;
+    // The muxers waiting for their details to be loaded
+    QList<FFMuxer *> _muxersToLoad;
+    // The processes loading muxer details in the background
+    QHash<QProcess *, FFMuxer *> _muxerDetailsProcesses;
+    // The muxers whose details could not be loaded, they're not cached
+    QList<FFMuxer *> _failedMuxerDetails;
+    bool _loadingMuxerDetails;
     // The list of pixel formats
     QList<FFPixFormat *> _pixFormats;
     // The list of audio sample formats
@@ -231,6 +292,23 @@ private:
     QList<FFColorProfile *> _colorProfiles;
     // The list of LUTs
     QList<FFLut *> _luts;
+    // The indexes to quickly find objects by name
+    FFObjectIndex<FFCodec> _videoEncodersIndex;
+    FFObjectIndex<FFCodec> _audioEncodersIndex;
+    FFObjectIndex<FFCodec> _videoDecodersIndex;
+    FFObjectIndex<FFCodec> _audioDecodersIndex;
+    FFObjectIndex<FFMuxer> _muxersIndex;
+    FFObjectIndex<FFPixFormat> _pixFormatsIndex;
+    FFObjectIndex<FFSampleFormat> _sampleFormatsIndex;
+    FFObjectIndex<FFColorItem> _colorPrimariesIndex;
+    FFObjectIndex<FFColorItem> _colorTRCsIndex;
+    FFObjectIndex<FFColorItem> _colorSpacesIndex;
+    FFObjectIndex<FFColorItem> _colorRangesIndex;
+    FFObjectIndex<FFColorProfile> _colorProfilesIndex;
+    FFObjectIndex<FFLut> _lutsIndex;
+    // The muxers by extension, built again when the extensions change
+    QHash<QString, FFMuxer *> _muxerExtensions;
+    bool _muxerExtensionsChanged;
     //The list of motion interpolation algorithms
     QList<FFBaseObject *> _motionInterpolationAlgorithms;
     //The list of motion estimation modes
@@ -249,6 +327,19 @@ private:
     int _prevMax;
     int _currentProgress;
 
+    /**
+     * @brief Looks for the ffprobe binary shipped with ffmpeg
+     * @param ffmpegPath The path to the ffmpeg binary
+     * @return The path to ffprobe, empty if not found
+     */
+    QString findFFprobe(QString ffmpegPath) const;
+    /**
+     * @brief Looks for the muxer using an extension
+     * @param extension The extension, without the dot
+     * @return The muxer, or nullptr if not found
+     */
+    FFMuxer *muxerByExtension(QString extension);
+
     //=== Process outputs ===
     /**
      * @brief ffmpeg_gotVersion Parses the version
@@ -256,11 +347,60 @@ private:
      */
     QString gotVersion(QString output);
     /**
-     * @brief ffmpeg_gotCodecs Parses the muxers list
+     * @brief ffmpeg_gotCodecs Parses the muxers list. The details of the muxers are read from the capabilities cache, or loaded in the background
      * @param output The output of the FFmpeg process with the muxers list
-     * @param newVersion The version of ffmpeg from which tt output comes from
      */
-    void gotMuxers(QString output, QString newVersion);
+    void gotMuxers(QString output);
+    /**
+     * @brief Parses the help of a muxer to get its default codecs and extensions
+     * @param muxer The muxer
+     * @param output The output of "ffmpeg -h muxer=name"
+     * @return false if the output is not the help of the muxer
+     */
+    bool gotMuxerDetails(FFMuxer *muxer, QString output);
+
+    //=== Muxer details ===
+    /**
+     * @brief Loads the details of the muxer right now if they're not available yet
+     * @param muxer The muxer
+     */
+    void loadMuxerDetails(FFMuxer *muxer);
+    /**
+     * @brief Loads the details of all the muxers which are not available yet
+     */
+    void loadAllMuxerDetails();
+    /**
+     * @brief Launches the processes loading the muxer details in the background, up to the number of cores
+     */
+    void launchMuxerDetails();
+    /**
+     * @brief Stops loading the muxer details
+     */
+    void cancelMuxerDetails();
+    /**
+     * @brief Saves the cache and emits muxersLoaded() when all the details are available
+     */
+    void checkMuxerDetails();
+
+    //=== Capabilities cache ===
+    /**
+     * @brief Gets the SHA1 of the ffmpeg binary. It is computed again only if the file changes.
+     * @return The hash, empty if the binary is not found
+     */
+    QString binaryHash();
+    /**
+     * @brief The path of the JSON file caching the capabilities of the current binary
+     * @return
+     */
+    QString capabilitiesCachePath();
+    /**
+     * @brief Reads the muxer details from the capabilities cache
+     */
+    void readCapabilitiesCache();
+    /**
+     * @brief Writes the muxer details to the capabilities cache
+     */
+    void writeCapabilitiesCache();
     /**
      * @brief ffmpeg_gotCodecs Parses the codec list
      * @param output The output of the FFmpeg process with the codecs list
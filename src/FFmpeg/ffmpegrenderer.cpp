@@ -2,27 +2,45 @@
 
 #include <QtDebug>
 
-// Singleton, instance is nullptr by default until instance() is called for the first time
-FFmpegRenderer *FFmpegRenderer::_instance = nullptr;
-
-FFmpegRenderer *FFmpegRenderer::instance()
-{
-    if (!_instance) _instance = new FFmpegRenderer();
-    return _instance;
-}
-
 FFmpegRenderer::FFmpegRenderer(QObject *parent) : AbstractRenderer(parent)
 {
     _ffmpeg = FFmpeg::instance();
 
+    _segmentMode = NoSegment;
+    _segmentIn = 0.0;
+    _segmentOut = 0.0;
+    _segmentFrames = 0;
+    _segmentsDir = nullptr;
+    _mergingSegments = false;
+    _sliceStartFrame = 0;
+    _encodingSlices = false;
+    _pipedInput = nullptr;
+    _pipedFrames = 0;
+    _exrDecoder = nullptr;
+    _exrInput = nullptr;
+    _transcoder = nullptr;
+
+    // The keys printed by -progress
+    _progressKeys << "frame" << "fps" << "bitrate" << "total_size" << "out_time_us" << "out_time_ms" << "out_time" << "dup_frames" << "drop_frames" << "speed" << "progress";
+
     initJob();
 }
 
+void FFmpegRenderer::setPipedInput(MediaInfo *media, int numFrames)
+{
+    _pipedInput = media;
+    _pipedFrames = numFrames;
+}
+
 bool FFmpegRenderer::launchJob()
 {
     qDebug() << "Launching FFMpeg Job";
     setStatus( MediaUtils::Launching );
 
+    // remove the segments of the previous job
+    cleanSegments();
+    _encodingSlices = false;
+
     // init job
     initJob();
 
@@ -31,6 +49,8 @@ bool FFmpegRenderer::launchJob()
 
     // setup outputs
     foreach(MediaInfo *output, _job->getOutputMedias()) setupOutput(output);
+    // run the filters common to several outputs only once
+    shareFilters();
 
     emit newLog("Beginning new encoding\nUsing FFmpeg input:\n" + _inputArgs.join(" | ") + "\nUsing FFmpeg output:\n" + _outputArgs.join(" | "));
 
@@ -39,11 +59,42 @@ bool FFmpegRenderer::launchJob()
 
     if (_jobFramerate != 0.0)
     {
-        this->setNumFrames( _jobDuration * _jobFramerate / _speedMultiplicator );
+        // Use the exact frame count given by the prober if the timing is unchanged
+        if (_inputNumFrames > 0 && _inputFramerate == _jobFramerate && _speedMultiplicator == 1.0) this->setNumFrames( _inputNumFrames );
+        else this->setNumFrames( _jobDuration * _jobFramerate / _speedMultiplicator );
         this->setFrameRate( _jobFramerate );
     }
 
+    // Image sequences may be converted frame by frame, without ffmpeg
+    if (launchTranscode()) return true;
+
+    // The frames of image sequences can be encoded in parallel
+    int numSlices = getNumSlices();
+    if (numSlices > 1)
+    {
+        launchSlices( numSlices );
+        return true;
+    }
+
+    // Long jobs can be split in segments encoded in parallel
+    int numSegments = getNumSegments();
+    if (numSegments > 1)
+    {
+        launchSegments( numSegments );
+        return true;
+    }
+
+    // The input of ffmpeg is the frames, not commands: the decoder stops ffmpeg by closing it
+    if (_exrDecoder != nullptr)
+    {
+        _exrStopCommand = stopCommand();
+        setStopCommand("");
+    }
     this->start( _inputArgs + _outputArgs );
+    // ffmpeg is ready to read the frames
+    if (_exrDecoder != nullptr) _exrDecoder->start( this );
+    // The next job reads its files
+    _pipedInput = nullptr;
     return true;
 }
 
@@ -51,14 +102,340 @@ void FFmpegRenderer::initJob()
 {
     _inputArgs.clear();
     _outputArgs.clear();
+    _outputFilters.clear();
+    _teeOutput = false;
+
+    if (_exrDecoder != nullptr)
+    {
+        _exrDecoder->stop();
+        _exrDecoder->deleteLater();
+        _exrDecoder = nullptr;
+    }
+    if (_exrStopCommand != "")
+    {
+        setStopCommand( _exrStopCommand );
+        _exrStopCommand = "";
+    }
+    _exrInput = nullptr;
+    if (_transcoder != nullptr)
+    {
+        _transcoder->stop();
+        _transcoder->deleteLater();
+        _transcoder = nullptr;
+    }
 
     _jobFramerate = 0.0;
     _jobDuration = 0.0;
+    _inputNumFrames = 0;
+    _inputFramerate = 0.0;
 
     _inputPrimaries = nullptr;
     _inputTrc = nullptr;
 
-    _inputArgs << "-loglevel" << "error" << "-stats" << "-y";
+    _speedMultiplicator = 1.0;
+
+    _progressPipe = _settings.value("ffmpeg/progressPipe", true).toBool();
+    _progressValues.clear();
+
+    _inputArgs += getGlobalOptions();
+}
+
+QStringList FFmpegRenderer::getGlobalOptions()
+{
+    QStringList globalArgs;
+    globalArgs << "-loglevel" << "error";
+    // Machine-readable progress on stdout, the errors stay on stderr
+    if (_progressPipe) globalArgs << "-nostats" << "-progress" << "pipe:1";
+    else globalArgs << "-stats";
+    globalArgs << "-y";
+    return globalArgs;
+}
+
+int FFmpegRenderer::getNumSegments()
+{
+    if (!_settings.value("ffmpeg/segmentEncoding", false).toBool()) return 1;
+    // The frames come one after the other from a pipe
+    if (_pipedInput != nullptr) return 1;
+    if (_exrDecoder != nullptr) return 1;
+
+    // A single video file output
+    if (_job->getOutputMedias().count() != 1) return 1;
+    MediaInfo *output = _job->getOutputMedias().at(0);
+    if (!output->hasVideo() || output->isSequence()) return 1;
+    // The segments are merged to a single destination
+    if (output->mirrors().count() > 0) return 1;
+    VideoInfo *stream = output->videoStreams().at(0);
+    FFCodec *codec = getFFCodec( stream, output->defaultVideoCodec() );
+    if (codec->name() == "copy" || codec->name() == "gif") return 1;
+    // Changing the speed changes the timing of the segments
+    if (_speedMultiplicator != 1.0) return 1;
+
+    // A single video input
+    int numVideoInputs = 0;
+    foreach(MediaInfo *input, _job->getInputMedias())
+    {
+        if (input->hasVideo()) numVideoInputs++;
+    }
+    if (numVideoInputs != 1) return 1;
+
+    if (_jobFramerate == 0.0 || numFrames() <= 0) return 1;
+
+    int numSegments = _settings.value("ffmpeg/maxSegments", 0).toInt();
+    // Auto: encoders use several threads, keep about 8 cores per process
+    if (numSegments <= 0) numSegments = QThread::idealThreadCount() / 8;
+
+    // Don't split in segments which are too short
+    double minDuration = _settings.value("ffmpeg/minSegmentDuration", 30.0).toDouble();
+    if (minDuration > 0)
+    {
+        int maxSegments = int( _jobDuration / minDuration );
+        if (numSegments > maxSegments) numSegments = maxSegments;
+    }
+
+    if (numSegments < 1) return 1;
+    return numSegments;
+}
+
+void FFmpegRenderer::launchSegments(int numSegments)
+{
+    MediaInfo *output = _job->getOutputMedias().at(0);
+    int totalFrames = numFrames();
+    double frameRate = _jobFramerate;
+
+    _segmentsDir = CacheManager::instance()->getSegmentsTempDir();
+    QString extension = QFileInfo( output->fileName() ).suffix();
+
+    QList<QStringList> argumentsList;
+
+    // Video, without audio: the segments are split on exact frames
+    _segmentMode = VideoSegment;
+    for (int i = 0; i < numSegments; i++)
+    {
+        int startFrame = int( qint64(i) * totalFrames / numSegments );
+        int endFrame = int( qint64(i + 1) * totalFrames / numSegments );
+
+        _segmentIn = startFrame / frameRate;
+        // Read one more frame, the exact number of frames is set on the output
+        _segmentOut = (endFrame + 1) / frameRate;
+        _segmentFrames = endFrame - startFrame;
+        _segmentFileName = _segmentsDir->path() + "/DuME_Segment_" + QString::number(i).rightJustified(4, '0') + "." + extension;
+        _segmentFiles << _segmentFileName;
+
+        initJob();
+        foreach( MediaInfo *input, _job->getInputMedias() ) setupInput(input);
+        setupOutput(output);
+        argumentsList << _inputArgs + _outputArgs;
+    }
+
+    // Audio is encoded in one go, to avoid gaps between the segments
+    if (output->hasAudio())
+    {
+        _segmentMode = AudioSegment;
+        _segmentsAudioFile = _segmentsDir->path() + "/DuME_Audio." + extension;
+        _segmentFileName = _segmentsAudioFile;
+
+        initJob();
+        foreach( MediaInfo *input, _job->getInputMedias() ) setupInput(input);
+        setupOutput(output);
+        argumentsList << _inputArgs + _outputArgs;
+    }
+
+    _segmentMode = NoSegment;
+    _jobFramerate = frameRate;
+
+    emit newLog("Encoding " + QString::number(numSegments) + " segments in parallel.");
+    foreach(QStringList arguments, argumentsList) emit newLog("Segment arguments:\n" + arguments.join(" | "), LogUtils::Debug);
+
+    this->start( argumentsList );
+}
+
+int FFmpegRenderer::getNumSlices()
+{
+    if (!_settings.value("ffmpeg/sequenceSlices", true).toBool()) return 1;
+    // The frames come one after the other from a pipe
+    if (_pipedInput != nullptr) return 1;
+    if (_exrDecoder != nullptr) return 1;
+
+    // A single image sequence output, the other outputs have no video
+    MediaInfo *sequence = nullptr;
+    foreach(MediaInfo *output, _job->getOutputMedias())
+    {
+        if (!output->hasVideo()) continue;
+        if (sequence != nullptr || !output->isSequence()) return 1;
+        sequence = output;
+    }
+    if (sequence == nullptr) return 1;
+    VideoInfo *stream = sequence->videoStreams().at(0);
+    FFCodec *codec = getFFCodec( stream, sequence->defaultVideoCodec() );
+    if (codec->name() == "copy") return 1;
+    // Changing the speed changes the timing of the slices
+    if (_speedMultiplicator != 1.0) return 1;
+    // Temporal filters need the frames before the slice
+    foreach(OutputFilters filters, _outputFilters)
+    {
+        if (filters.chain.join(",").contains("minterpolate")) return 1;
+    }
+
+    // A single video input
+    int numVideoInputs = 0;
+    foreach(MediaInfo *input, _job->getInputMedias())
+    {
+        if (input->hasVideo()) numVideoInputs++;
+    }
+    if (numVideoInputs != 1) return 1;
+
+    if (_jobFramerate == 0.0 || numFrames() <= 0) return 1;
+
+    int numSlices = _settings.value("ffmpeg/maxSequenceSlices", 0).toInt();
+    // Auto: image encoders barely use more than one core
+    if (numSlices <= 0) numSlices = QThread::idealThreadCount() / 2;
+
+    // Each process has to read and set up the filters, don't split in slices which are too short
+    int minFrames = _settings.value("ffmpeg/minSliceFrames", 10).toInt();
+    if (minFrames > 0)
+    {
+        int maxSlices = numFrames() / minFrames;
+        if (numSlices > maxSlices) numSlices = maxSlices;
+    }
+
+    if (numSlices < 1) return 1;
+    return numSlices;
+}
+
+void FFmpegRenderer::launchSlices(int numSlices)
+{
+    int totalFrames = numFrames();
+    double frameRate = _jobFramerate;
+
+    MediaInfo *sequence = nullptr;
+    QList<MediaInfo *> audioOutputs;
+    foreach(MediaInfo *output, _job->getOutputMedias())
+    {
+        if (output->hasVideo()) sequence = output;
+        else audioOutputs << output;
+    }
+
+    QList<QStringList> argumentsList;
+
+    // Each slice writes its frames to the output sequence, numbered from its first frame
+    _segmentMode = SequenceSlice;
+    for (int i = 0; i < numSlices; i++)
+    {
+        int startFrame = int( qint64(i) * totalFrames / numSlices );
+        int endFrame = int( qint64(i + 1) * totalFrames / numSlices );
+
+        _segmentIn = startFrame / frameRate;
+        // Read one more frame, the exact number of frames is set on the output
+        _segmentOut = (endFrame + 1) / frameRate;
+        _segmentFrames = endFrame - startFrame;
+        _sliceStartFrame = startFrame;
+
+        initJob();
+        foreach( MediaInfo *input, _job->getInputMedias() ) setupInput(input);
+        setupOutput(sequence);
+        argumentsList << _inputArgs + _outputArgs;
+    }
+
+    // The other outputs are encoded by a separate process
+    if (audioOutputs.count() > 0)
+    {
+        _segmentMode = NoSegment;
+
+        initJob();
+        foreach( MediaInfo *input, _job->getInputMedias() ) setupInput(input);
+        foreach( MediaInfo *output, audioOutputs ) setupOutput(output);
+        argumentsList << _inputArgs + _outputArgs;
+    }
+
+    _segmentMode = NoSegment;
+    _sliceStartFrame = 0;
+    _jobFramerate = frameRate;
+    _encodingSlices = true;
+
+    emit newLog("Encoding the image sequence in " + QString::number(numSlices) + " slices in parallel.");
+    foreach(QStringList arguments, argumentsList) emit newLog("Slice arguments:\n" + arguments.join(" | "), LogUtils::Debug);
+
+    this->start( argumentsList );
+}
+
+bool FFmpegRenderer::launchNextStep()
+{
+    // The slices write the frames of the output, there's nothing to merge
+    if (_encodingSlices)
+    {
+        _encodingSlices = false;
+        if (failedProcesses() == 0) return false;
+        emit newLog("Some slices of the image sequence could not be encoded, frames are missing.", LogUtils::Critical);
+        setStatus( MediaUtils::Error );
+        return true;
+    }
+
+    // Nothing to merge
+    if (_segmentFiles.count() == 0) return false;
+
+    // Merged, we're done
+    if (_mergingSegments)
+    {
+        cleanSegments();
+        return false;
+    }
+
+    if (failedProcesses() > 0)
+    {
+        emit newLog("Some segments could not be encoded, the output can't be generated.", LogUtils::Critical);
+        cleanSegments();
+        setStatus( MediaUtils::Error );
+        return true;
+    }
+
+    MediaInfo *output = _job->getOutputMedias().at(0);
+
+    // List the segments for the concat demuxer
+    QFile listFile( _segmentsDir->path() + "/DuME_Segments.txt" );
+    if (!listFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        emit newLog("Can't write the list of segments, the output can't be generated.", LogUtils::Critical);
+        cleanSegments();
+        setStatus( MediaUtils::Error );
+        return true;
+    }
+    QTextStream list(&listFile);
+    foreach(QString segment, _segmentFiles)
+    {
+        // Quotes have to be escaped for the concat demuxer
+        segment = QDir::fromNativeSeparators( segment ).replace("'", "'\\''");
+        list << "file '" << segment << "'\n";
+    }
+    list.flush();
+    listFile.close();
+
+    QStringList arguments;
+    arguments += getGlobalOptions();
+    arguments << "-f" << "concat" << "-safe" << "0" << "-i" << QDir::toNativeSeparators( listFile.fileName() );
+    if (_segmentsAudioFile != "") arguments << "-i" << QDir::toNativeSeparators( _segmentsAudioFile );
+    arguments << "-map" << "0:v";
+    if (_segmentsAudioFile != "") arguments << "-map" << "1:a";
+    arguments << "-c" << "copy";
+    arguments += getMuxer( output );
+    arguments << getFileName( output );
+
+    emit newLog("Merging the segments:\n" + arguments.join(" | "));
+
+    _mergingSegments = true;
+    this->start( arguments );
+    return true;
+}
+
+void FFmpegRenderer::cleanSegments()
+{
+    _segmentFiles.clear();
+    _segmentsAudioFile = "";
+    _mergingSegments = false;
+
+    if (_segmentsDir == nullptr) return;
+    _segmentsDir->remove();
+    delete _segmentsDir;
+    _segmentsDir = nullptr;
 }
 
 void FFmpegRenderer::setupInput(MediaInfo *inputMedia)
@@ -77,17 +454,52 @@ void FFmpegRenderer::setupInput(MediaInfo *inputMedia)
         if (videoStream->framerate() != 0.0) _jobFramerate = videoStream->framerate();
         else _jobFramerate = 24;
 
+        // Keep the exact frame count of the whole input
+        if (videoStream->numFrames() > _inputNumFrames && !inputMedia->isSequence() && inputMedia->inPoint() == 0.0 && inputMedia->outPoint() == 0.0)
+        {
+            _inputNumFrames = videoStream->numFrames();
+            _inputFramerate = _jobFramerate;
+        }
+
         // Get Sequence settings
-        _inputArgs += getInputSequenceSettings( videoStream );
+        if (inputMedia == _pipedInput) _inputArgs << "-f" << "image2pipe" << "-framerate" << QString::number( _jobFramerate );
+        else
+        {
+            // EXR frames may be decoded by OpenImageIO, faster than ffmpeg
+            QStringList exrSettings = getEXRInputSettings( inputMedia );
+            if (exrSettings.count() > 0) _inputArgs += exrSettings;
+            else _inputArgs += getInputSequenceSettings( videoStream );
+        }
 
         // Get Color metadata
         if (videoStream->workingSpace()->name() != "") _inputArgs += getColorMetadata( videoStream, inputMedia->defaultColorProfile(), true );
     }
 
+    // The frames are written to stdin, they may not all exist yet
+    if (inputMedia == _pipedInput)
+    {
+        double pipedDuration = _pipedFrames / _jobFramerate;
+        if (pipedDuration > _jobDuration) _jobDuration = pipedDuration;
+        if (inputMedia->hasVideo())
+        {
+            QString decoder = inputMedia->videoStreams().at(0)->codec()->name();
+            if (decoder != "") _inputArgs << "-c:v" << decoder;
+        }
+        _inputArgs << "-i" << "-";
+        return;
+    }
+
     // Update job duration
     double testDuration = getMediaDuration( inputMedia );
     if (testDuration > _jobDuration) _jobDuration = testDuration;
 
+    // The decoded frames are written to stdin, already trimmed to the time range
+    if (inputMedia == _exrInput)
+    {
+        _inputArgs << "-i" << "-";
+        return;
+    }
+
     // Time Range
     _inputArgs += getTimeRange( inputMedia );
 
@@ -130,6 +542,215 @@ QStringList FFmpegRenderer::getInputSequenceSettings(VideoInfo *sequence)
     return sequenceSettings;
 }
 
+QStringList FFmpegRenderer::getEXRInputSettings(MediaInfo *media)
+{
+    QStringList exrSettings;
+    // Only one input can be sent to stdin
+    if (_exrDecoder != nullptr || _pipedInput != nullptr) return exrSettings;
+    if (!DuEXR::isAvailable()) return exrSettings;
+    if (!_settings.value("exr/nativeDecoding", true).toBool()) return exrSettings;
+    if (!media->isSequence()) return exrSettings;
+    if (QFileInfo( media->fileName() ).suffix().toLower() != "exr") return exrSettings;
+
+    // Custom options are meant for the ffmpeg EXR decoder
+    foreach(QStringList option, media->ffmpegOptions())
+    {
+        if (option[0] != "-filter:v" && option[0] != "-vf") return exrSettings;
+    }
+
+    // There's no seeking in a pipe
+    QStringList frames = getSequenceFrames( media );
+    if (frames.count() == 0) return exrSettings;
+
+    DuEXR *decoder = new DuEXR(frames, this);
+    if (!decoder->readSpec())
+    {
+        delete decoder;
+        emit newLog("Can't decode the EXR sequence with OpenImageIO, it will be read by ffmpeg.");
+        return exrSettings;
+    }
+    _exrDecoder = decoder;
+    _exrInput = media;
+
+    exrSettings << "-f" << "rawvideo";
+    exrSettings << "-pix_fmt" << decoder->pixFormat();
+    exrSettings << "-video_size" << QString::number( decoder->width() ) + "x" + QString::number( decoder->height() );
+    exrSettings << "-framerate" << QString::number( _jobFramerate );
+
+    emit newLog("EXR sequence decoded with OpenImageIO:\n" + exrSettings.join(" "));
+
+    return exrSettings;
+}
+
+QStringList FFmpegRenderer::getSequenceFrames(MediaInfo *media)
+{
+    QStringList frames = media->frames();
+    double framerate = media->videoStreams().at(0)->framerate();
+    if (framerate == 0.0) framerate = 24.0;
+
+    int first = 0;
+    int last = frames.count();
+    if (media->inPoint() != 0.0) first = qRound( media->inPoint() * framerate );
+    if (media->outPoint() != 0.0) last = qRound( media->outPoint() * framerate );
+    if (first < 0) first = 0;
+    if (last > frames.count()) last = frames.count();
+    if (last <= first) return QStringList();
+    return frames.mid(first, last - first);
+}
+
+bool FFmpegRenderer::launchTranscode()
+{
+    DuEXR::OutputSettings frameSettings;
+    if (!canTranscode( frameSettings )) return false;
+
+    MediaInfo *input = _job->getInputMedias().at(0);
+    MediaInfo *output = _job->getOutputMedias().at(0);
+    QStringList frames = getSequenceFrames( input );
+    if (frames.count() == 0) return false;
+
+    // ffmpeg is not run, nor fed
+    if (_exrDecoder != nullptr)
+    {
+        delete _exrDecoder;
+        _exrDecoder = nullptr;
+        _exrInput = nullptr;
+    }
+
+    emit newLog("Converting the frames with OpenImageIO:\n" +
+                frameSettings.channels.join("") + " " + frameSettings.format + " " + frameSettings.compression);
+
+    QDir().mkpath( QFileInfo( output->fileName() ).absolutePath() );
+
+    _transcoder = new DuEXR(frames, this);
+    connect( _transcoder, &DuEXR::frameTranscoded, this, &FFmpegRenderer::transcodeProgress );
+    connect( _transcoder, &DuEXR::finished, this, &FFmpegRenderer::transcodeFinished );
+
+    this->setNumFrames( frames.count() );
+    _startTime = QTime::currentTime();
+    setStatus( MediaUtils::Encoding );
+
+    _transcoder->transcode( output->fileName(), output->videoStreams().at(0)->startNumber(), frameSettings );
+    return true;
+}
+
+bool FFmpegRenderer::canTranscode(DuEXR::OutputSettings &settings)
+{
+    if (!DuEXR::isAvailable()) return false;
+    if (!_settings.value("exr/nativeTranscoding", true).toBool()) return false;
+    if (_pipedInput != nullptr) return false;
+
+    // A single image sequence to a single image sequence
+    if (_job->getInputMedias().count() != 1 || _job->getOutputMedias().count() != 1) return false;
+    MediaInfo *input = _job->getInputMedias().at(0);
+    MediaInfo *output = _job->getOutputMedias().at(0);
+    if (!input->isSequence() || !input->hasVideo()) return false;
+    if (!output->isSequence() || !output->hasVideo() || output->hasAudio()) return false;
+    if (output->mirrors().count() > 0) return false;
+    if (!DuEXR::isSupported( QFileInfo( input->fileName() ).suffix() )) return false;
+    QString extension = QFileInfo( output->fileName() ).suffix().toLower();
+    if (!DuEXR::isSupported( extension )) return false;
+
+    // Filters need ffmpeg
+    if (_outputFilters.count() > 0) return false;
+    // And so do the options of the ffmpeg decoders
+    foreach(QStringList option, input->ffmpegOptions())
+    {
+        if (option[0] != "-filter:v" && option[0] != "-vf") return false;
+    }
+
+    VideoInfo *inputStream = input->videoStreams().at(0);
+    VideoInfo *outputStream = output->videoStreams().at(0);
+    if (getFFCodec( outputStream, output->defaultVideoCodec() )->name() == "copy") return false;
+    // ffmpeg drops or duplicates frames to change the framerate
+    if (outputStream->framerate() != 0.0 && outputStream->framerate() != inputStream->framerate()) return false;
+    if (_speedMultiplicator != 1.0) return false;
+
+    // The compression options of the ffmpeg encoders, any other option needs ffmpeg
+    settings.compression = "";
+    foreach(QStringList option, output->ffmpegOptions())
+    {
+        QString opt = option[0];
+        QString value = option.value(1);
+        if (opt == "-filter:v" || opt == "-vf") continue;
+        if (opt == "-compression" && extension == "exr")
+        {
+            // OpenImageIO also has piz, pxr24, b44, dwaa...
+            if (value == "zip1") value = "zips";
+            else if (value == "zip16") value = "zip";
+            settings.compression = value;
+        }
+        else if (opt == "-compression_algo" && (extension == "tif" || extension == "tiff"))
+        {
+            if (value == "raw") value = "none";
+            else if (value == "deflate") value = "zip";
+            settings.compression = value;
+        }
+        else if (opt == "-compression_level" && extension == "png") settings.compression = "zip:" + value;
+        else return false;
+    }
+    if ((extension == "jpg" || extension == "jpeg") && outputStream->quality() >= 0) settings.compression = "jpeg:" + QString::number( outputStream->quality() );
+
+    // ffmpeg keeps the closest pixel format if it's not set
+    FFPixFormat *pixFormat = outputStream->pixFormat();
+    bool keepFormat = pixFormat->name() == "";
+    if (keepFormat) pixFormat = inputStream->pixFormat();
+    int bits = 8;
+    if (pixFormat->name() != "")
+    {
+        // Gray and YUV frames need a conversion
+        if (pixFormat->numComponents() < 3 || pixFormat->colorSpace() == FFPixFormat::YUV) return false;
+        bits = pixFormat->bitsPerPixel() / pixFormat->numComponents();
+    }
+
+    settings.channels = QStringList() << "R" << "G" << "B";
+    if (pixFormat->hasAlpha() && extension != "jpg" && extension != "jpeg") settings.channels << "A";
+
+    settings.format = "";
+    settings.bitsPerSample = 0;
+    if (extension == "exr")
+    {
+        if (!keepFormat && bits > 16) settings.format = "float";
+        else if (!keepFormat) settings.format = "half";
+    }
+    else if (bits > 8 && extension != "jpg" && extension != "jpeg")
+    {
+        settings.format = "uint16";
+        if (extension == "dpx" && bits < 16) settings.bitsPerSample = bits;
+    }
+    else settings.format = "uint8";
+
+    return true;
+}
+
+void FFmpegRenderer::transcodeProgress(int numFrames)
+{
+    // The job is being stopped
+    if (status() == MediaUtils::Cleaning)
+    {
+        _transcoder->stop();
+        setStatus( MediaUtils::Stopped );
+        return;
+    }
+
+    setCurrentFrame( numFrames );
+    emit progress();
+}
+
+void FFmpegRenderer::transcodeFinished()
+{
+    if (!MediaUtils::isBusy( status() )) return;
+
+    QStringList failedFrames = _transcoder->failedFrames();
+    if (failedFrames.count() > 0)
+    {
+        emit newLog(QString::number( failedFrames.count() ) + " frames could not be converted:\n" + failedFrames.join("\n"), LogUtils::Warning);
+        setStatus( MediaUtils::Error );
+        return;
+    }
+
+    setStatus( MediaUtils::Finished );
+}
+
 QStringList FFmpegRenderer::getColorMetadata(VideoInfo *videoStream, FFColorProfile *defaultProfile, bool isInput)
 {
     QStringList colorArgs;
@@ -175,8 +796,17 @@ double FFmpegRenderer::getMediaDuration(MediaInfo *media)
 QStringList FFmpegRenderer::getTimeRange(MediaInfo *media)
 {
     QStringList timeRangeArgs;
-    if (media->inPoint() != 0.0) timeRangeArgs << "-ss" << QString::number( media->inPoint() );
-    if (media->outPoint() != 0.0) timeRangeArgs << "-to" << QString::number( media->outPoint() );
+    // Encoding a segment or a slice, relative to the in point
+    if (_segmentMode == VideoSegment || _segmentMode == SequenceSlice)
+    {
+        timeRangeArgs << "-ss" << QString::number( media->inPoint() + _segmentIn, 'f', 6 );
+        timeRangeArgs << "-to" << QString::number( media->inPoint() + _segmentOut, 'f', 6 );
+    }
+    else
+    {
+        if (media->inPoint() != 0.0) timeRangeArgs << "-ss" << QString::number( media->inPoint() );
+        if (media->outPoint() != 0.0) timeRangeArgs << "-to" << QString::number( media->outPoint() );
+    }
 
     emit newLog("Time range:\n" + timeRangeArgs.join(" "));
     return timeRangeArgs;
@@ -197,17 +827,36 @@ void FFmpegRenderer::setupOutput(MediaInfo *outputMedia)
 {
     emit newLog("Output Setup");
 
+    int argsStart = _outputArgs.count();
+
+    // The same encode is written to the mirror destinations by the tee muxer
+    bool tee = _segmentMode == NoSegment && outputMedia->mirrors().count() > 0;
+    if (tee && outputMedia->isSequence())
+    {
+        emit newLog("Mirror destinations are not available for image sequences, only the main destination is written.", LogUtils::Warning);
+        tee = false;
+    }
+
     //maps
     _outputArgs += getMaps( outputMedia );
+    // The tee muxer does not select the streams
+    if (tee && outputMedia->maps().isEmpty()) _outputArgs += getDefaultMaps( outputMedia );
 
     //muxer
-    _outputArgs += getMuxer( outputMedia );
+    QStringList muxerArgs = getMuxer( outputMedia );
+    if (tee)
+    {
+        _outputArgs << "-f" << "tee";
+        // The encoders can't know if the muxers need the global headers
+        if (needsGlobalHeader( muxerArgs.value(1), outputMedia->fileName() )) _outputArgs << "-flags" << "+global_header";
+    }
+    else _outputArgs += muxerArgs;
 
     //custom options
     _outputArgs += getFFmpegCustomOptions( outputMedia );
 
     //video
-    if (outputMedia->hasVideo())
+    if (outputMedia->hasVideo() && _segmentMode != AudioSegment)
     {
         // There's only a single video stream in outputs in DuME for now.
         VideoInfo *videoStream = outputMedia->videoStreams().at(0);
@@ -236,14 +885,28 @@ void FFmpegRenderer::setupOutput(MediaInfo *outputMedia)
             // Color Metadata
             if (videoStream->workingSpace()->name() != "") if ( videoStream->colorConversionMode() != MediaUtils::Convert) _outputArgs += getColorMetadata( videoStream, outputMedia->defaultColorProfile() );
             // Filters
-            _outputArgs += getFilters( outputMedia, videoStream );
+            QStringList filterChain = getFilterChain( outputMedia, videoStream );
+            if (filterChain.count() > 0)
+            {
+                // Keep the filters, they may be shared with other outputs
+                OutputFilters filters;
+                filters.media = outputMedia;
+                filters.argsStart = argsStart;
+                filters.filtersIndex = _outputArgs.count();
+                filters.chain = filterChain;
+                filters.mapped = tee || !outputMedia->maps().isEmpty();
+                _outputFilters << filters;
+            }
+            _outputArgs += getFilters( filterChain );
+            // Length of the segment
+            if (_segmentMode == VideoSegment || _segmentMode == SequenceSlice) _outputArgs << "-frames:v" << QString::number( _segmentFrames );
         }
     }
     else _outputArgs += "-vn";
 
 
     //audio
-    if (outputMedia->hasAudio())
+    if (outputMedia->hasAudio() && _segmentMode != VideoSegment)
     {
         // There's only a single audio stream in outputs in DuME for now.
         AudioInfo *audioStream = outputMedia->audioStreams().at(0);
@@ -268,10 +931,80 @@ void FFmpegRenderer::setupOutput(MediaInfo *outputMedia)
 
     //file
     QString outputPath = getFileName( outputMedia );
+    if (_segmentMode == VideoSegment || _segmentMode == AudioSegment) outputPath = QDir::toNativeSeparators( _segmentFileName );
+    else if (tee)
+    {
+        outputPath = getTeeOutput( outputMedia, muxerArgs.value(1), outputPath );
+        // The tee muxer does not report any size, get it from the main destination
+        if (outputMedia == _job->getOutputMedias().at(0)) _teeOutput = true;
+    }
 
     _outputArgs << outputPath;
 }
 
+QStringList FFmpegRenderer::getDefaultMaps(MediaInfo *media)
+{
+    QStringList maps;
+    QList<MediaInfo*> inputs = _job->getInputMedias();
+
+    // The first video and audio streams
+    if (media->hasVideo())
+    {
+        for (int i = 0; i < inputs.count(); i++)
+        {
+            if (!inputs.at(i)->hasVideo()) continue;
+            maps << "-map" << QString::number(i) + ":v:0";
+            break;
+        }
+    }
+    if (media->hasAudio())
+    {
+        for (int i = 0; i < inputs.count(); i++)
+        {
+            if (!inputs.at(i)->hasAudio()) continue;
+            maps << "-map" << QString::number(i) + ":a:0";
+            break;
+        }
+    }
+
+    emit newLog("Default stream maps:\n" + maps.join(" "));
+    return maps;
+}
+
+QString FFmpegRenderer::getTeeOutput(MediaInfo *media, QString muxer, QString outputPath)
+{
+    QString format = "";
+    if (muxer != "") format = "f=" + muxer + ":";
+
+    // The main destination fails the job, not the mirrors
+    QStringList destinations;
+    if (muxer != "") destinations << "[f=" + muxer + "]" + escapeTeeOutput( outputPath );
+    else destinations << escapeTeeOutput( outputPath );
+    foreach(QString mirror, media->mirrors())
+    {
+        destinations << "[" + format + "onfail=ignore]" + escapeTeeOutput( QDir::toNativeSeparators( mirror ) );
+    }
+
+    emit newLog("Mirror destinations:\n" + media->mirrors().join("\n"));
+    return destinations.join("|");
+}
+
+QString FFmpegRenderer::escapeTeeOutput(QString path)
+{
+    return path.replace("\\", "\\\\").replace("|", "\\|").replace("[", "\\[").replace("]", "\\]").replace("'", "\\'");
+}
+
+bool FFmpegRenderer::needsGlobalHeader(QString muxer, QString fileName)
+{
+    QStringList muxers;
+    muxers << "mp4" << "mov" << "ipod" << "ismv" << "3gp" << "3g2" << "f4v" << "flv" << "matroska" << "webm" << "mxf";
+    if (muxer != "") return muxers.contains(muxer);
+
+    QStringList extensions;
+    extensions << "mp4" << "m4v" << "m4a" << "mov" << "ismv" << "3gp" << "3g2" << "f4v" << "flv" << "mkv" << "mka" << "webm" << "mxf";
+    return extensions.contains( QFileInfo(fileName).suffix().toLower() );
+}
+
 QStringList FFmpegRenderer::getMaps(MediaInfo *media)
 {
     QStringList maps;
@@ -522,6 +1255,8 @@ QStringList FFmpegRenderer::getOutputSequenceSettings(VideoInfo *stream)
     if (!stream->isSequence()) return sequenceSettings;
 
     int startNumber = stream->startNumber();
+    // The frames of a slice follow the previous slices
+    if (_segmentMode == SequenceSlice) startNumber += _sliceStartFrame;
     sequenceSettings << "-start_number" << QString::number(startNumber);
 
     emit newLog("Sequebce output settings:\n" + sequenceSettings.join(" "));
@@ -557,7 +1292,18 @@ QStringList FFmpegRenderer::getPixelFormatSettings(VideoInfo *stream, FFPixForma
     return pixelArgs;
 }
 
-QStringList FFmpegRenderer::getFilters(MediaInfo *media, VideoInfo *stream)
+QStringList FFmpegRenderer::getFilters(QStringList filterChain)
+{
+    filterChain = bakeFilters( filterChain );
+
+    QStringList filters;
+    if (filterChain.count() > 0) filters << "-vf" << filterChain.join(",");
+
+    emit newLog("Video Filters:\n" + filters.join(" "));
+    return filters;
+}
+
+QStringList FFmpegRenderer::getFilterChain(MediaInfo *media, VideoInfo *stream)
 {
     QStringList filterChain;
 
@@ -598,12 +1344,190 @@ QStringList FFmpegRenderer::getFilters(MediaInfo *media, VideoInfo *stream)
 
     //compile filters
     filterChain.removeAll(QString(""));
+    QStringList originalChain = filterChain;
 
-    QStringList filters;
-    if (filterChain.count() > 0) filters << "-vf" << filterChain.join(",");
+    //reorder and simplify
+    if (_settings.value("ffmpeg/optimizeFilters", true).toBool())
+    {
+        FilterOptimizer optimizer( filtersSourceSize( stream ), cropFilter( stream ) );
+        filterChain = optimizer.optimize( filterChain );
+        foreach(QString change, optimizer.changes()) emit newLog("Filter graph optimization: " + change, LogUtils::Debug);
+    }
 
-    emit newLog("Video Filters:\n" + filters.join(" "));
-    return filters;
+    if (_settings.value("ffmpeg/showFilterGraph", false).toBool() && filterChain != originalChain)
+    {
+        emit newLog("Video filter graph:\n    " + originalChain.join("\n    ") + "\nOptimized:\n    " + filterChain.join("\n    "));
+    }
+
+    return filterChain;
+}
+
+QStringList FFmpegRenderer::bakeFilters(QStringList filterChain)
+{
+    //bake consecutive color transforms into single 3D LUTs
+    int numFilters = filterChain.count();
+    filterChain = LutBaker::instance()->bake( filterChain );
+    if (filterChain.count() < numFilters) emit newLog("Color transforms baked into 3D LUTs: " + QString::number(filterChain.count()) + " filters instead of " + QString::number(numFilters) + ".");
+    return filterChain;
+}
+
+QString FFmpegRenderer::filtersSource(MediaInfo *output)
+{
+    QList<MediaInfo*> inputs = _job->getInputMedias();
+
+    // ffmpeg selects the video stream
+    if (output->maps().isEmpty())
+    {
+        int videoInput = -1;
+        for (int i = 0; i < inputs.count(); i++)
+        {
+            if (!inputs.at(i)->hasVideo()) continue;
+            // With several video inputs, ffmpeg selects the one with the highest resolution
+            if (videoInput >= 0) return "";
+            videoInput = i;
+        }
+        if (videoInput < 0) return "";
+        return QString::number(videoInput) + ":v:0";
+    }
+
+    // The single video stream mapped
+    QString source = "";
+    foreach (StreamReference map, output->maps())
+    {
+        int mediaId = map.mediaId();
+        if (mediaId < 0 || mediaId >= inputs.count()) continue;
+        foreach(VideoInfo *stream, inputs.at(mediaId)->videoStreams())
+        {
+            if (stream->id() != map.streamId()) continue;
+            if (source != "") return "";
+            source = QString::number( mediaId ) + ":" + QString::number( map.streamId() );
+        }
+    }
+    return source;
+}
+
+void FFmpegRenderer::shareFilters()
+{
+    if (_outputFilters.count() < 2) return;
+    if (!_settings.value("ffmpeg/shareFilters", true).toBool()) return;
+
+    // Without explicit maps, ffmpeg selects the other streams itself (the best audio of all inputs, subtitles...).
+    // Once the video is mapped to the graph, only a single audio stream can be selected the same way.
+    QList<MediaInfo*> inputs = _job->getInputMedias();
+    int numAudioStreams = 0;
+    int numSubtitleStreams = 0;
+    foreach(MediaInfo *input, inputs)
+    {
+        numAudioStreams += input->audioStreams().count();
+        numSubtitleStreams += input->numSubtitleStreams();
+    }
+    bool defaultStreams = numAudioStreams <= 1 && numSubtitleStreams == 0;
+
+    // Group the outputs by source stream
+    QMap<QString, QList<int>> sources;
+    for (int i = 0; i < _outputFilters.count(); i++)
+    {
+        if (!_outputFilters.at(i).mapped && !defaultStreams) continue;
+        QString source = filtersSource( _outputFilters.at(i).media );
+        if (source != "") sources[source] << i;
+    }
+
+    QStringList graphs;
+    // The new maps of the outputs, by output
+    QHash<int, QStringList> outputMaps;
+
+    QMapIterator<QString, QList<int>> it(sources);
+    while (it.hasNext())
+    {
+        it.next();
+        QList<int> outputs = it.value();
+        if (outputs.count() < 2) continue;
+
+        // The filters common to all outputs
+        QStringList prefix = _outputFilters.at(outputs.at(0)).chain;
+        foreach(int o, outputs)
+        {
+            QStringList chain = _outputFilters.at(o).chain;
+            int common = 0;
+            while (common < prefix.count() && common < chain.count() && prefix.at(common) == chain.at(common)) common++;
+            prefix = prefix.mid(0, common);
+        }
+        if (prefix.isEmpty()) continue;
+
+        // [source]prefix,split=n[s0][s1];[s0]tail0[v0];[s1]tail1[v1]
+        QString graph = "[" + it.key() + "]" + bakeFilters( prefix ).join(",") + ",split=" + QString::number(outputs.count());
+        QStringList tails;
+        foreach(int o, outputs)
+        {
+            QString outputLabel = "[dume_v" + QString::number(o) + "]";
+            QStringList tail = bakeFilters( _outputFilters.at(o).chain.mid(prefix.count()) );
+            if (tail.isEmpty())
+            {
+                graph += outputLabel;
+            }
+            else
+            {
+                QString splitLabel = "[dume_s" + QString::number(o) + "]";
+                graph += splitLabel;
+                tails << splitLabel + tail.join(",") + outputLabel;
+            }
+
+            QStringList maps;
+            maps << "-map" << outputLabel;
+            // ffmpeg does not select the other streams anymore when a map is set
+            MediaInfo *output = _outputFilters.at(o).media;
+            if (!_outputFilters.at(o).mapped && output->hasAudio())
+            {
+                for (int i = 0; i < inputs.count(); i++)
+                {
+                    if (!inputs.at(i)->hasAudio()) continue;
+                    maps << "-map" << QString::number(i) + ":a:0";
+                    break;
+                }
+            }
+            outputMaps.insert(o, maps);
+        }
+        graphs << ( QStringList(graph) + tails ).join(";");
+
+        emit newLog("Sharing " + QString::number(prefix.count()) + " video filters between " + QString::number(outputs.count()) + " outputs.");
+    }
+
+    if (graphs.isEmpty()) return;
+
+    // Replace the filters and video maps of the outputs, from the last one so that the positions of the previous ones don't change
+    for (int o = _outputFilters.count() - 1; o >= 0; o--)
+    {
+        if (!outputMaps.contains(o)) continue;
+        OutputFilters filters = _outputFilters.at(o);
+
+        // -vf chain
+        _outputArgs.removeAt(filters.filtersIndex);
+        _outputArgs.removeAt(filters.filtersIndex);
+
+        // The video map is now the output of the graph
+        QString source = filtersSource( filters.media );
+        int i = filters.argsStart;
+        while (i + 1 < _outputArgs.count() && _outputArgs.at(i) == "-map")
+        {
+            if (_outputArgs.at(i + 1) == source)
+            {
+                _outputArgs.removeAt(i);
+                _outputArgs.removeAt(i);
+                continue;
+            }
+            i += 2;
+        }
+        QStringList maps = outputMaps.value(o);
+        for (int m = maps.count() - 1; m >= 0; m--) _outputArgs.insert(filters.argsStart, maps.at(m));
+    }
+
+    foreach(QString graph, graphs)
+    {
+        _outputArgs.prepend(graph);
+        _outputArgs.prepend("-filter_complex");
+    }
+
+    emit newLog("Shared video filters:\n" + graphs.join("\n"));
 }
 
 QString FFmpegRenderer::unpremultiplyFilter(VideoInfo *stream)
@@ -1022,6 +1946,47 @@ QStringList FFmpegRenderer::resizeFilters(VideoInfo *stream)
     return sizeFilters;
 }
 
+QSize FFmpegRenderer::filtersSourceSize(VideoInfo *stream)
+{
+    if (!_job) return QSize();
+
+    QSize size;
+    foreach(MediaInfo *input, _job->getInputMedias())
+    {
+        if (!input->hasVideo()) continue;
+        VideoInfo *inputStream = input->videoStreams().at(0);
+        size = QSize( inputStream->width(), inputStream->height() );
+
+        // ffmpeg rotates the frames before the filters, unless told not to
+        bool autoRotate = true;
+        foreach(QStringList option, input->ffmpegOptions())
+        {
+            if (option[0] == "-noautorotate" || (option[0] == "-autorotate" && option.count() > 1 && option[1] == "0")) autoRotate = false;
+        }
+        int rotation = qAbs( inputStream->rotation() ) % 180;
+        if (autoRotate && rotation == 90) size.transpose();
+        // The size of the rotated frames is not known exactly
+        else if (autoRotate && rotation != 0) return QSize();
+        break;
+    }
+    if (size.width() <= 0 || size.height() <= 0) return QSize();
+
+    // Same as cropFilter()
+    if (!stream->cropUseSize())
+    {
+        size.rwidth() -= stream->leftCrop() + stream->rightCrop();
+        size.rheight() -= stream->topCrop() + stream->bottomCrop();
+    }
+    else
+    {
+        if (stream->cropWidth() != 0) size.setWidth( stream->cropWidth() );
+        if (stream->cropHeight() != 0) size.setHeight( stream->cropHeight() );
+    }
+    if (size.width() <= 0 || size.height() <= 0) return QSize();
+
+    return size;
+}
+
 bool FFmpegRenderer::colorManagement()
 {
     qDebug() << "Color management";
@@ -1137,29 +2102,13 @@ FFColorProfile *FFmpegRenderer::convertInputForLut()
 
 QString FFmpegRenderer::getLutFilter(FFLut *lut)
 {
+    //check if it's 3D or 1D
+    LutInfo info = lut->info();
     QString filterName = "lut3d";
-    QString lutName = lut->extract();
+    if (info.dimension == 1) filterName = "lut1d";
 
-    //check if it's 3D or 1D
-    if (lutName.endsWith(".cube"))
-    {
-        QFile l(lutName);
-        if (l.open(QIODevice::ReadOnly | QIODevice::Text))
-        {
-             QTextStream in(&l);
-             QString line = in.readLine();
-             while (!line.isNull())
-             {
-                 if (line.trimmed().toUpper().startsWith("LUT_1D"))
-                 {
-                     filterName = "lut1d";
-                     break;
-                 }
-                 line = in.readLine();
-             }
-             l.close();
-        }
-    }
+    QString lutName = info.path;
+    if (lutName == "") lutName = lut->name();
 
     return generateFilter(filterName, lutName.replace("\\","/"));
 }
@@ -1194,6 +2143,9 @@ QString FFmpegRenderer::generateFilter(QString filterName, QString arg)
 
 void FFmpegRenderer::readyRead(QString output)
 {
+    // key=value lines from the progress pipe
+    if (_progressPipe && readProgress(output)) return;
+
     emit console(output);
 
     QRegularExpression reProgress = RegExUtils::getRegEx("ffmpeg progress");
@@ -1209,12 +2161,19 @@ void FFmpegRenderer::readyRead(QString output)
 
          //size
         int sizeKB = size.toInt();
+        // Read the size of the main destination
+        if (_teeOutput) sizeKB = 0;
 
         //bitrate
         int bitrateKB = bitrate.toInt();
 
-        //frame
-        setCurrentFrame( frame.toInt(), sizeKB * 1024, bitrateKB * 1000, speed.toDouble() );
+        // The merge of the segments is just a copy, keep the progress of the segments
+        if (_mergingSegments) return;
+
+        //frame, summed over the segments or slices if any
+        int processId = -1;
+        if (_segmentFiles.count() > 0 || _encodingSlices) processId = outputProcessId();
+        setCurrentFrame( frame.toInt(), sizeKB * 1024, bitrateKB * 1000, speed.toDouble(), processId );
 
         setStatus(MediaUtils::FFmpegEncoding);
 
@@ -1233,3 +2192,54 @@ void FFmpegRenderer::readyRead(QString output)
     }
 }
 
+bool FFmpegRenderer::readProgress(QString line)
+{
+    int sep = line.indexOf('=');
+    if (sep <= 0) return false;
+
+    QString key = line.left(sep);
+    if (!_progressKeys.contains(key) && !key.startsWith("stream_")) return false;
+
+    // One value for each key, until the "progress" key which ends the block
+    int processId = outputProcessId();
+    QString value = line.mid(sep + 1).trimmed();
+    _progressValues[processId].insert(key, value);
+    if (key != "progress") return true;
+
+    // The merge of the segments is just a copy, keep the progress of the segments
+    if (_mergingSegments) return true;
+
+    QHash<QString, QString> values = _progressValues.take(processId);
+
+    int frame = values.value("frame").toInt();
+    // Values are "N/A" when unknown, which converts to 0
+    double size = values.value("total_size").toDouble();
+    // Read the size of the main destination
+    if (_teeOutput) size = 0;
+    QString bitrate = values.value("bitrate");
+    bitrate.chop( QString("kbits/s").count() );
+    QString speed = values.value("speed");
+    speed.chop(1);
+
+    // Audio only: deduce the frame from the time
+    if (frame == 0 && _segmentFiles.count() == 0 && !_encodingSlices && _jobFramerate > 0)
+    {
+        frame = int( values.value("out_time_us").toDouble() / 1000000.0 * _jobFramerate );
+    }
+
+    emit console( "frame=" + QString::number(frame) +
+                  " size=" + QString::number( int(size / 1024) ) + "kB" +
+                  " time=" + values.value("out_time") +
+                  " bitrate=" + values.value("bitrate") +
+                  " speed=" + values.value("speed") );
+
+    //frame, summed over the segments or slices if any
+    if (_segmentFiles.count() > 0 || _encodingSlices) setCurrentFrame( frame, size, bitrate.toDouble() * 1000, speed.toDouble(), processId );
+    else setCurrentFrame( frame, size, bitrate.toDouble() * 1000, speed.toDouble() );
+
+    setStatus(MediaUtils::FFmpegEncoding);
+
+    emit progress();
+
+    return true;
+}
@@ -2,30 +2,55 @@
 #define FFMPEGRENDERER_H
 
 #include "Renderer/abstractrenderer.h"
+#include "Renderer/cachemanager.h"
+#include "Renderer/lutbaker.h"
+#include "Renderer/filteroptimizer.h"
+#include "duexr.h"
 
 #include <QObject>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QMap>
+#include <QHash>
 
 class FFmpegRenderer : public AbstractRenderer
 {
 public:
     /**
-     * @brief Gets the unique instance of FFmpegRenderer, constructing it if it's the first call.
-     * @return
+     * @brief Constructs a new ffmpeg renderer. There is one renderer per RenderQueue slot.
+     * @param parent
      */
-    static FFmpegRenderer *instance();
+    FFmpegRenderer(QObject *parent = nullptr);
 
-protected:
     /**
-     * @brief The unique FFmpegRenderer instance
+     * @brief Makes the next job read the frames of this image sequence from the standard input instead of its files.
+     * The frames are then written with writeInput(), and closeInput() ends the stream.
+     * This applies to the next job only.
+     * @param media The input image sequence
+     * @param numFrames The number of frames which will be written
      */
-    static FFmpegRenderer *_instance;
+    void setPipedInput(MediaInfo *media, int numFrames);
+
+protected:
     /**
      * @brief re-implemented from AbstractRenderer to interpret ffmpeg output
      * @param output
      */
     void readyRead(QString output);
+    /**
+     * @brief re-implemented from AbstractRenderer to merge the segments when encoding in segment mode
+     * @return
+     */
+    bool launchNextStep();
 
 private:
+    /**
+     * @brief The part of the media being set up when encoding in segment mode, or a slice of the frames of an image sequence
+     */
+    enum SegmentMode { NoSegment, VideoSegment, AudioSegment, SequenceSlice };
+
     // ======= OBJECTS =========
 
     // The FFmpeg instance
@@ -39,16 +64,66 @@ private:
     double _jobFramerate;
     double _jobDuration;
     double _speedMultiplicator;
+    // The exact frame count of the longest video input, when known, and its framerate
+    int _inputNumFrames;
+    double _inputFramerate;
     FFColorItem *_inputTrc;
     FFColorItem *_inputPrimaries;
 
-    // ======= SINGLETON CONSTRUCTOR =======
+    // Segment-parallel encoding
+    QSettings _settings;
+    SegmentMode _segmentMode;
+    // The time range of the segment being set up, in seconds
+    double _segmentIn;
+    double _segmentOut;
+    // The number of frames of the segment being set up
+    int _segmentFrames;
+    // The file of the segment being set up
+    QString _segmentFileName;
+    // The temp dir containing the segments of the current job
+    QTemporaryDir *_segmentsDir;
+    // The encoded segments and audio, to be merged
+    QStringList _segmentFiles;
+    QString _segmentsAudioFile;
+    bool _mergingSegments;
+    // The first frame of the slice being set up, relative to the start of the output sequence
+    int _sliceStartFrame;
+    // The slices of an image sequence are being encoded
+    bool _encodingSlices;
 
-    /**
-     * @brief FFmpegRenderer is a singleton, the constructor is private
-     * @param parent
-     */
-    FFmpegRenderer(QObject *parent = nullptr);
+    // The input read from stdin, and its number of frames
+    MediaInfo *_pipedInput;
+    int _pipedFrames;
+    // The EXR sequence decoded by DuEXR and sent to stdin
+    MediaInfo *_exrInput;
+    DuEXR *_exrDecoder;
+    // The stop command to restore once the decoder is not used anymore
+    QString _exrStopCommand;
+    // Converts the frames without ffmpeg, when both ends are image sequences
+    DuEXR *_transcoder;
+
+    // The video filters of the outputs being set up
+    class OutputFilters
+    {
+    public:
+        MediaInfo *media;
+        // The position of the arguments of the output, and of its -vf argument
+        int argsStart;
+        int filtersIndex;
+        // The filters, not baked
+        QStringList chain;
+        // True if the streams of the output are explicitly mapped
+        bool mapped;
+    };
+    QList<OutputFilters> _outputFilters;
+    // The first output is written through the tee muxer
+    bool _teeOutput;
+
+    // Progress read from the -progress pipe
+    bool _progressPipe;
+    QStringList _progressKeys;
+    // The values of the block being read, for each process
+    QHash<int, QHash<QString, QString>> _progressValues;
 
     // ======= METHODS =========
 
@@ -61,6 +136,44 @@ private:
      * @brief Initializes arguments
      */
     void initJob();
+    /**
+     * @brief Builds the global options (logs, progress)
+     * @return The arguments
+     */
+    QStringList getGlobalOptions();
+    /**
+     * @brief Reads a key=value line printed by ffmpeg with -progress, and updates the progress at the end of each block
+     * @param line The line
+     * @return false if the line is not a progress line
+     */
+    bool readProgress(QString line);
+    /**
+     * @brief Gets the number of segments to split the current job into, to encode them in parallel processes
+     * @return The number of segments, 1 if the job can't (or should not) be split
+     */
+    int getNumSegments();
+    /**
+     * @brief Splits the current job in segments and launches a process for each of them.
+     * The segments are merged with the concat demuxer by launchNextStep() once they're all encoded.
+     * @param numSegments The number of segments
+     */
+    void launchSegments(int numSegments);
+    /**
+     * @brief Gets the number of slices to split the frames of an image sequence output into, to encode them in parallel processes
+     * @return The number of slices, 1 if the job can't (or should not) be split
+     */
+    int getNumSlices();
+    /**
+     * @brief Splits the frame range of the image sequence output and launches a process for each slice.
+     * Each process writes its frames directly to the output, with its own start number.
+     * The outputs without video are encoded by another process.
+     * @param numSlices The number of slices
+     */
+    void launchSlices(int numSlices);
+    /**
+     * @brief Removes the temporary segments
+     */
+    void cleanSegments();
     /**
      * @brief Prepares the input and gets its arguments
      * @param inputMedia The media
@@ -78,6 +191,30 @@ private:
      * @return The arguments
      */
     QStringList getInputSequenceSettings(VideoInfo *sequence);
+    /**
+     * @brief Sets up the decoding of an EXR sequence with OpenImageIO, the frames are sent to the standard input as raw video.
+     * Only one input per job can be decoded this way.
+     * @param media The input media
+     * @return The input arguments, or an empty list if the sequence has to be read by ffmpeg
+     */
+    QStringList getEXRInputSettings(MediaInfo *media);
+    /**
+     * @brief Gets the frames of an input sequence, in the time range
+     */
+    QStringList getSequenceFrames(MediaInfo *media);
+    /**
+     * @brief Converts the frames with OpenImageIO instead of running ffmpeg, if the job allows it
+     * @return true if the conversion has been launched
+     */
+    bool launchTranscode();
+    /**
+     * @brief Checks if the job only converts an image sequence to another one, frame by frame, without filters
+     * @param settings Set to the format of the output frames
+     * @return false if ffmpeg is needed
+     */
+    bool canTranscode(DuEXR::OutputSettings &settings);
+    void transcodeProgress(int numFrames);
+    void transcodeFinished();
     /**
      * @brief Builds the video color metadata arguments
      * @param videoStream The stream
@@ -212,11 +349,52 @@ private:
      */
     QStringList getPixelFormatSettings(VideoInfo *stream, FFPixFormat *pixFormat);
     /**
-     * @brief Builds the filter chain
+     * @brief Maps the first video and audio streams of the inputs, the way ffmpeg selects them by default
+     * @return The arguments
+     */
+    QStringList getDefaultMaps(MediaInfo *media);
+    /**
+     * @brief Builds the tee muxer output writing the main destination and the mirrors.
+     * The job fails if the main destination can't be written, while failing mirrors are just skipped.
+     * @param media The output media
+     * @param muxer The muxer of the output, empty to guess it from the file names
+     * @param outputPath The main destination
+     * @return The tee output
+     */
+    QString getTeeOutput(MediaInfo *media, QString muxer, QString outputPath);
+    static QString escapeTeeOutput(QString path);
+    /**
+     * @brief Checks if the encoders must put the headers in the container instead of the stream (for MP4, MOV, MKV...)
+     * @param muxer The muxer, or an empty string to check the file name
+     * @param fileName The output file
+     */
+    static bool needsGlobalHeader(QString muxer, QString fileName);
+    /**
+     * @brief Builds the filter chain, optimized but not baked
      * @param stream The stream
+     * @return The filters
+     */
+    QStringList getFilterChain(MediaInfo *media, VideoInfo *stream);
+    /**
+     * @brief Bakes the color transforms of the filter chain, and builds the -vf argument
+     * @param filterChain The filters
      * @return The arguments
      */
-    QStringList getFilters(MediaInfo *media, VideoInfo *stream);
+    QStringList getFilters(QStringList filterChain);
+    /**
+     * @brief Bakes consecutive color transforms into 3D LUTs
+     */
+    QStringList bakeFilters(QStringList filterChain);
+    /**
+     * @brief Gets the input video stream filtered for an output
+     * @return The stream specifier, or an empty string if it can't be known
+     */
+    QString filtersSource(MediaInfo *output);
+    /**
+     * @brief Replaces the -vf chains of the outputs reading the same stream with a -filter_complex graph,
+     * running the filters common to all outputs once and splitting the frames to the filters specific to each output
+     */
+    void shareFilters();
     QString unpremultiplyFilter(VideoInfo *stream);
     QString deinterlaceFilter(VideoInfo *stream);
     QStringList motionFilters(VideoInfo *stream);
@@ -229,6 +407,11 @@ private:
     QStringList inputColorConversionFilters(VideoInfo *stream);
     QStringList applyLutFilters(VideoInfo *stream, FFColorProfile *colorProfile);
     QStringList resizeFilters(VideoInfo *stream);
+    /**
+     * @brief The size of the frames entering the filter chain: the size of the first video input, cropped
+     * @return An invalid size if it's unknown
+     */
+    QSize filtersSourceSize(VideoInfo *stream);
     /**
      * @brief Checks if the output needs a color conversion depending on both input & output formats, and sets it up
      * @return
@@ -0,0 +1,63 @@
+#ifndef FFOBJECTINDEX_H
+#define FFOBJECTINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The FFObjectIndex class indexes a list of FFBaseObject (or subclasses) by name and pretty name.
+ * The name is case insensitive, the pretty name is not.
+ * When several objects share the same name, the first one in the list wins, as with a linear search.
+ */
+template <typename T>
+class FFObjectIndex
+{
+public:
+    /**
+     * @brief Rebuilds the index from a list of objects
+     * @param objects The objects
+     */
+    void index(const QList<T *> &objects)
+    {
+        clear();
+        foreach(T *o, objects) insert(o);
+    }
+    /**
+     * @brief Adds an object to the index. If another object already uses the same name, it is kept.
+     * @param o The object
+     */
+    void insert(T *o)
+    {
+        QString name = o->name().toLower();
+        if (!_names.contains(name)) _names.insert(name, o);
+        if (!_prettyNames.contains(o->prettyName())) _prettyNames.insert(o->prettyName(), o);
+    }
+    /**
+     * @brief Removes all objects from the index
+     */
+    void clear()
+    {
+        _names.clear();
+        _prettyNames.clear();
+    }
+    /**
+     * @brief Looks for an object by name, then by pretty name
+     * @param name The name or pretty name
+     * @param defaultValue The object to return if nothing is found
+     * @return The object
+     */
+    T *value(QString name, T *defaultValue = nullptr) const
+    {
+        name = name.trimmed();
+        T *o = _names.value(name.toLower(), nullptr);
+        if (o) return o;
+        return _prettyNames.value(name, defaultValue);
+    }
+
+private:
+    QHash<QString, T *> _names;
+    QHash<QString, T *> _prettyNames;
+};
+
+#endif // FFOBJECTINDEX_H
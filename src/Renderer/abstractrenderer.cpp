@@ -18,13 +18,23 @@ AbstractRenderer::AbstractRenderer(QObject *parent) : QObject(parent)
     _elapsedTime = QTime(0,0,0,0);
 
     _outputFileName = "";
+    _outputTracker = new OutputTracker(this);
 
     _binaryFileName = "";
 
     _stopCommand = "";
 
-    _output = "";
-    _timer = QElapsedTimer();
+    _numLaunchedProcesses = 0;
+    _failedProcesses = 0;
+    _outputProcessId = -1;
+
+    _job = nullptr;
+    _jobDetached = false;
+}
+
+OutputTracker *AbstractRenderer::outputTracker() const
+{
+    return _outputTracker;
 }
 
 int AbstractRenderer::currentFrame() const
@@ -65,6 +75,7 @@ QString AbstractRenderer::outputFileName() const
 void AbstractRenderer::setOutputFileName(const QString &outputFileName)
 {
     _outputFileName = outputFileName;
+    _outputTracker->setOutput( outputFileName );
 }
 
 void AbstractRenderer::setStopCommand(const QString &stopCommand)
@@ -72,12 +83,15 @@ void AbstractRenderer::setStopCommand(const QString &stopCommand)
     _stopCommand = stopCommand;
 }
 
+QString AbstractRenderer::stopCommand() const
+{
+    return _stopCommand;
+}
+
 void AbstractRenderer::start( QStringList arguments, int numThreads )
 {
     setStatus( MediaUtils::Launching );
 
-    _timer.start();
-
     qDebug().noquote() << "Launching " + QString::number( numThreads ) + " processes.";
     for (int i = 0; i < numThreads; i++ )
     {
@@ -88,6 +102,20 @@ void AbstractRenderer::start( QStringList arguments, int numThreads )
     setStatus( MediaUtils::Encoding );
 }
 
+void AbstractRenderer::start(QList<QStringList> argumentsList)
+{
+    setStatus( MediaUtils::Launching );
+
+    qDebug().noquote() << "Launching " + QString::number( argumentsList.count() ) + " processes.";
+    foreach( QStringList arguments, argumentsList )
+    {
+        launchProcess( arguments );
+    }
+    _startTime = QTime::currentTime();
+
+    setStatus( MediaUtils::Encoding );
+}
+
 void AbstractRenderer::stop(int timeout)
 {
     qDebug().noquote() << "Sending the stop command";
@@ -110,18 +138,45 @@ void AbstractRenderer::stop(int timeout)
     QTimer::singleShot(timeout, this, SLOT( killRenderProcesses()) );
 }
 
+bool AbstractRenderer::writeInput(const QByteArray &data)
+{
+    bool written = false;
+    foreach( QProcess *renderProcess, _renderProcesses )
+    {
+        if (renderProcess->state() == QProcess::NotRunning) continue;
+        if (renderProcess->write( data ) == data.count()) written = true;
+    }
+    return written;
+}
+
+qint64 AbstractRenderer::inputBufferSize() const
+{
+    qint64 size = 0;
+    foreach( QProcess *renderProcess, _renderProcesses ) size += renderProcess->bytesToWrite();
+    return size;
+}
+
+void AbstractRenderer::closeInput()
+{
+    foreach( QProcess *renderProcess, _renderProcesses ) renderProcess->closeWriteChannel();
+}
+
+void AbstractRenderer::detachJob()
+{
+    _jobDetached = true;
+    disconnect(_jobConnection);
+}
+
 void AbstractRenderer::processStdError()
 {
     QProcess* process = qobject_cast<QProcess*>(sender());
-    QString log = process->readAllStandardError();
-    processOutput( log );
+    processOutput( process, _stdErrLines, process->readAllStandardError() );
 }
 
 void AbstractRenderer::processStdOutput()
 {
     QProcess* process = qobject_cast<QProcess*>(sender());
-    QString log = process->readAllStandardOutput();
-    processOutput( log );
+    processOutput( process, _stdOutLines, process->readAllStandardOutput() );
 }
 
 void AbstractRenderer::processStarted()
@@ -134,10 +189,12 @@ void AbstractRenderer::processStarted()
 
 void AbstractRenderer::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    processOutput("\n", true);
     // Get the process
     QProcess* process = qobject_cast<QProcess*>(sender());
+    flushOutput(process);
     int id = _renderProcesses.indexOf(process);
+    int processId = _processIds.value(process, -1);
+    bool failed = exitStatus == QProcess::CrashExit || exitCode != 0;
 
     if (exitStatus == QProcess::NormalExit)
     {
@@ -147,24 +204,31 @@ void AbstractRenderer::processFinished(int exitCode, QProcess::ExitStatus exitSt
     {
         qDebug().noquote() << "Process " + QString::number(id + 1) + " has crashed with code " + QString::number(exitCode) + ". Some output files may be corrupted";
     }
+    if (failed) _failedProcesses++;
 
     _renderProcesses.removeAt(id);
-    process->deleteLater();
+    removeProcess(process);
+
+    // The renderer may have more work for a new process
+    processEnded(processId, failed);
 
     //if all processes have finished
     if ( _renderProcesses.count() == 0 )
     {
-        disconnect(this, &AbstractRenderer::statusChanged, _job, &QueueItem::setStatus);
+        // There may be another step to run with the results (not when stopping or after an error)
+        if ( MediaUtils::isBusy( _status ) && _status != MediaUtils::Cleaning && launchNextStep() ) return;
+
+        disconnect(_jobConnection);
         setStatus( MediaUtils::Finished );
-        if (_job->status() != MediaUtils::Error) _job->setStatus(MediaUtils::Finished);
+        if (!_jobDetached && _job->status() != MediaUtils::Error) _job->setStatus(MediaUtils::Finished);
 
     }
 }
 
 void AbstractRenderer::processErrorOccurred(QProcess::ProcessError e)
 {
-    processOutput("\n", true);
     QProcess* process = qobject_cast<QProcess*>(sender());
+    flushOutput(process);
     int id = _renderProcesses.indexOf(process) + 1;
 
     QString error;
@@ -211,8 +275,7 @@ void AbstractRenderer::processErrorOccurred(QProcess::ProcessError e)
         //remove all processes
         while( _renderProcesses.count() > 0 )
         {
-            QProcess *process = _renderProcesses.takeLast();
-            process->deleteLater();
+            removeProcess( _renderProcesses.takeLast() );
         }
 
         setStatus( MediaUtils::Error );
@@ -231,48 +294,58 @@ void AbstractRenderer::killRenderProcesses()
             qDebug().noquote() << "Killed process " + QString::number( _renderProcesses.count() + 1 ) ;
             killed = true;
         }
-        rp->deleteLater();
+        removeProcess(rp);
     }
     if (killed) emit newLog("Some processes did not stop correctly and had to be killed. The output file may be corrupted.");
 
     setStatus( MediaUtils::Stopped );
 }
 
-void AbstractRenderer::processOutputLine()
+void AbstractRenderer::processOutputLine(QString line)
 {
-    _output = _output.trimmed();
-    qDebug() << _output;
-    if (_output != "") readyRead(_output);
-    _output = "";
+    line = line.trimmed();
+    qDebug() << line;
+    if (line != "") readyRead(line);
 }
 
-void AbstractRenderer::processOutput(QString output, bool ignoreTimer)
+void AbstractRenderer::processOutput(QProcess *process, QHash<QProcess *, LineSplitter *> &splitters, const QByteArray &output)
 {
-    _outputBuffer += output;
-    if (!_timer.hasExpired(100) && !ignoreTimer) return;
+    // Each process and channel has its own buffer, so their lines don't interleave
+    LineSplitter *splitter = splitters.value(process);
+    if (!splitter) return;
+    splitter->append(output);
 
-    QStringList outputs = _outputBuffer.split(QRegularExpression("[\\n\\r]"));
+    _outputProcessId = _processIds.value(process, -1);
 
-    if (outputs.count() > 1)
+    // The splitter may be removed while processing a line (if the process is removed)
+    QString line;
+    while ( (splitter = splitters.value(process)) && splitter->readLine(line) )
     {
-        for (int i = 0 ; i < outputs.count() -1 ; i++)
-        {
-            if (i == 0) _output += outputs.at(i);
-            else _output = outputs.at(i);
-            processOutputLine();
-        }
-        // last one
-        if (_outputBuffer.endsWith("\n") || _outputBuffer.endsWith("\r")) _outputBuffer = outputs.last() + "\n";
+        processOutputLine(line);
     }
+}
 
-    _output += _outputBuffer;
+void AbstractRenderer::flushOutput(QProcess *process)
+{
+    if (!_processIds.contains(process)) return;
 
-    if (_output.endsWith("\n") || _output.endsWith("\r"))
-    {
-        processOutputLine();
-    }
+    // Read what's left and the incomplete last lines
+    processOutput( process, _stdOutLines, process->readAllStandardOutput() );
+    processOutput( process, _stdErrLines, process->readAllStandardError() );
 
-    _outputBuffer = "";
+    _outputProcessId = _processIds.value(process, -1);
+    LineSplitter *splitter = _stdOutLines.value(process);
+    if (splitter) processOutputLine( splitter->takeRemaining() );
+    splitter = _stdErrLines.value(process);
+    if (splitter) processOutputLine( splitter->takeRemaining() );
+}
+
+void AbstractRenderer::removeProcess(QProcess *process)
+{
+    _processIds.remove(process);
+    delete _stdOutLines.take(process);
+    delete _stdErrLines.take(process);
+    process->deleteLater();
 }
 
 bool AbstractRenderer::launchJob()
@@ -280,6 +353,27 @@ bool AbstractRenderer::launchJob()
     return false;
 }
 
+bool AbstractRenderer::launchNextStep()
+{
+    return false;
+}
+
+void AbstractRenderer::processEnded(int processId, bool failed)
+{
+    Q_UNUSED(processId);
+    Q_UNUSED(failed);
+}
+
+int AbstractRenderer::outputProcessId() const
+{
+    return _outputProcessId;
+}
+
+int AbstractRenderer::failedProcesses() const
+{
+    return _failedProcesses;
+}
+
 MediaUtils::RenderStatus AbstractRenderer::status() const
 {
     return _status;
@@ -300,10 +394,19 @@ void AbstractRenderer::setStatus(MediaUtils::RenderStatus status)
 
 bool AbstractRenderer::render(QueueItem *job)
 {
+    // The renderer may be reused for other items, don't update the previous one anymore
+    disconnect(_jobConnection);
     _job = job;
-    connect(this, &AbstractRenderer::statusChanged, _job, &QueueItem::setStatus);
+    _jobDetached = false;
+    _numLaunchedProcesses = 0;
+    _failedProcesses = 0;
+    _processFrames.clear();
+    _processSizes.clear();
+    _jobConnection = connect(this, &AbstractRenderer::statusChanged, _job, &QueueItem::setStatus);
     setStatus( MediaUtils:: Launching );
-    return launchJob();
+    if (launchJob()) return true;
+    disconnect(_jobConnection);
+    return false;
 }
 
 double AbstractRenderer::expectedSize() const
@@ -336,8 +439,22 @@ void AbstractRenderer::setNumFrames(int numFrames)
     _numFrames = numFrames;
 }
 
-void AbstractRenderer::setCurrentFrame(int currentFrame, double size, double bitrate, double speed)
+void AbstractRenderer::setCurrentFrame(int currentFrame, double size, double bitrate, double speed, int processId)
 {
+    // Sum the progress of all the processes
+    if (processId >= 0)
+    {
+        _processFrames[processId] = currentFrame;
+        _processSizes[processId] = size;
+        currentFrame = 0;
+        size = 0;
+        foreach(int frames, _processFrames) currentFrame += frames;
+        foreach(double processSize, _processSizes) size += processSize;
+        // Bitrate and speed of a single process are not relevant for the whole media, they'll be computed
+        bitrate = 0;
+        speed = 0;
+    }
+
     _currentFrame = currentFrame;
 
     qDebug() << "Progress: " + QString::number( _currentFrame );
@@ -365,28 +482,8 @@ void AbstractRenderer::setCurrentFrame(int currentFrame, double size, double bit
     //compute size
     if (size == 0)
     {
-        //get file(s)
-        //check if it's a sequence
-        QRegularExpression regExDigits("({#+})");
-        QRegularExpressionMatch regExDigitsMatch = regExDigits.match( _outputFileName );
-        QFileInfo infoOutput( _outputFileName );
-        // get all frames
-        if ( regExDigitsMatch.hasMatch() )
-        {
-            QDir containingDir = infoOutput.dir();
-            QString baseName = infoOutput.fileName();
-            QFileInfoList files = containingDir.entryInfoList( QStringList( baseName.replace( regExDigits, "*") ), QDir::Files);
-            _outputSize = 0;
-            foreach( QFileInfo file, files)
-            {
-                _outputSize += file.size();
-            }
-        }
-        //get video file
-        else
-        {
-            _outputSize = infoOutput.size();
-        }
+        _outputTracker->update();
+        _outputSize = _outputTracker->size();
     }
     else
     {
@@ -429,7 +526,7 @@ void AbstractRenderer::readyRead(QString output)
     //emit progress();
 }
 
-void AbstractRenderer::launchProcess( QStringList arguments )
+int AbstractRenderer::launchProcess( QStringList arguments )
 {
     //create process
     QProcess *renderer = new QProcess(this);
@@ -443,7 +540,13 @@ void AbstractRenderer::launchProcess( QStringList arguments )
 
     //TODO check processor affinity?
     _renderProcesses << renderer;
+    int id = _numLaunchedProcesses;
+    _processIds[renderer] = id;
+    _stdOutLines[renderer] = new LineSplitter();
+    _stdErrLines[renderer] = new LineSplitter();
+    _numLaunchedProcesses++;
     ProcessUtils::runProcess( renderer, _binaryFileName, arguments);
 
     qDebug().noquote() << "Launched process: " + QString::number( _renderProcesses.count() );
+    return id;
 }
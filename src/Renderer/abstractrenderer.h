@@ -6,12 +6,14 @@
 #include <QElapsedTimer>
 #include <QProcess>
 #include <QTimer>
-#include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QFileInfoList>
 #include <QDir>
+#include <QHash>
 
 #include "Renderer/queueitem.h"
+#include "Renderer/linesplitter.h"
+#include "Renderer/outputtracker.h"
 #include "duqf-utils/utils.h"
 
 /**
@@ -32,8 +34,10 @@ public:
     /**
      * @brief setCurrentFrame Sets the current frame being rendered and updates all progress info (size, time, bitrate...)
      * @param currentFrame
+     * @param processId When the processes render different parts of the media, the id of the process reporting this progress.
+     * The frames and sizes of all the processes are then summed. Use -1 when all processes report the progress of the whole media.
      */
-    void setCurrentFrame(int currentFrame, double size = 0, double bitrate = 0, double speed = 0);
+    void setCurrentFrame(int currentFrame, double size = 0, double bitrate = 0, double speed = 0, int processId = -1);
     /**
      * @brief startTime The start time of the rendering process
      * @return
@@ -114,16 +118,41 @@ public:
      * @default ""
      */
     void setStopCommand(const QString &stopCommand);
+    QString stopCommand() const;
     /**
      * @brief start Starts a rendering process
      * @param arguments The arguments to pass to the renderer
      */
     void start(QStringList arguments , int numThreads = 1);
+    /**
+     * @brief start Starts several rendering processes with different arguments
+     * @param argumentsList The arguments to pass to each process
+     */
+    void start(QList<QStringList> argumentsList);
     /**
      * @brief stop Stops the current process(es)
      * @param timeout Kills the process after timeout if it does not respond to the stop commands. In milliseconds.
      */
     void stop(int timeout = 10000);
+    /**
+     * @brief Writes data to the standard input of the running process(es), when they read their input from a pipe
+     * @param data The data
+     * @return false if there's no running process
+     */
+    bool writeInput(const QByteArray &data);
+    /**
+     * @brief The number of bytes written with writeInput() which have not been sent to the process(es) yet
+     * @return
+     */
+    qint64 inputBufferSize() const;
+    /**
+     * @brief Closes the standard input of the running process(es), which then know they've received all their data
+     */
+    void closeInput();
+    /**
+     * @brief Stops updating the status of the current job, when another renderer takes care of it while this one is still running
+     */
+    void detachJob();
 
 signals:
     /**
@@ -158,6 +187,8 @@ protected:
 
     // the output fileName
     QString _outputFileName;
+    // keeps track of the files written to the output
+    OutputTracker *_outputTracker;
     // the number of frames to render
     int _numFrames;
     // the framerate of the video
@@ -181,6 +212,19 @@ protected:
 
     //Called when the process outputs something on stdError or stdOutput. Reimplement this method to interpret the output. It has to emit progress() at the end, and can use setCurrentFrame().
     virtual void readyRead(QString output);
+    // Called when all the processes have finished. Reimplement this method to launch another step using the result of the processes (merge...).
+    // Return true if new processes have been launched or if the renderer has already set the final status of the job.
+    virtual bool launchNextStep();
+    // Called each time a process has finished, before checking if all processes have finished. Reimplement this method to give more work to the renderer (launchProcess()).
+    virtual void processEnded(int processId, bool failed);
+    //Launches a new process, and returns its id
+    int launchProcess(QStringList arguments );
+    // The size and number of files of the output
+    OutputTracker *outputTracker() const;
+    // The id of the process which has emitted the output being read in readyRead(). Ids are given in launch order for the current job, starting at 0.
+    int outputProcessId() const;
+    // The number of processes which have crashed or returned an error code for the current job
+    int failedProcesses() const;
 
 private slots:
     // gets the output from the render process(es)
@@ -196,19 +240,31 @@ private:
     // The process(es)
     QList<QProcess *> _renderProcesses;
     QString _binaryFileName;
+    // The ids of the processes
+    QHash<QProcess *, int> _processIds;
+    // The number of processes launched for the current job
+    int _numLaunchedProcesses;
+    // The number of processes which have failed for the current job
+    int _failedProcesses;
     // The status of the renderer
     MediaUtils::RenderStatus _status;
-    // The output
-    QString _output;
-    // Output buffer
-    QString _outputBuffer;
+    // The output buffers (incomplete lines), one per process and channel
+    QHash<QProcess *, LineSplitter *> _stdOutLines;
+    QHash<QProcess *, LineSplitter *> _stdErrLines;
+    // The id of the process being read
+    int _outputProcessId;
+    // The progress of each process, when they render different parts of the media
+    QHash<int, int> _processFrames;
+    QHash<int, double> _processSizes;
     // Process an outputLine
-    void processOutputLine();
+    void processOutputLine(QString line);
 
     // Process the outputs
-    void processOutput(QString output, bool ignoreTimer = false);
-    // A timer to process outputs only if a certain amount of time has passed to improve perf
-    QElapsedTimer _timer;
+    void processOutput(QProcess *process, QHash<QProcess *, LineSplitter *> &splitters, const QByteArray &output);
+    // Reads the remaining outputs of a process which has finished
+    void flushOutput(QProcess *process);
+    // Forgets a process and deletes it
+    void removeProcess(QProcess *process);
 
     // CONFIGURATION
     QString _stopCommand;
@@ -220,8 +276,11 @@ private:
      * @return True if the render is launched, false if not/nothing to launch
      */
     virtual bool launchJob();
-    //Launches a new process
-    void launchProcess(QStringList arguments );
+
+    // The connection between the status of the renderer and the status of the current job
+    QMetaObject::Connection _jobConnection;
+    // True when the renderer does not update the status of the current job anymore
+    bool _jobDetached;
 
 protected:
     // The current job
@@ -0,0 +1,248 @@
+#include "batchrunner.h"
+
+BatchRunner::BatchRunner(QString jobFilePath, QObject *parent) : QObject(parent)
+{
+    _jobFilePath = jobFilePath;
+    _error = "";
+    _finished = false;
+}
+
+bool BatchRunner::start()
+{
+    QFile jobFile(_jobFilePath);
+    if (!jobFile.open(QIODevice::ReadOnly))
+    {
+        _error = "Cannot read the job file: " + _jobFilePath;
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonDocument jobDoc = QJsonDocument::fromJson(jobFile.readAll(), &parseError);
+    jobFile.close();
+
+    if (!jobDoc.isObject())
+    {
+        _error = "Invalid job file: " + parseError.errorString();
+        return false;
+    }
+
+    QJsonObject mainObj = jobDoc.object();
+
+    if (mainObj.contains("maxConcurrentJobs")) RenderQueue::instance()->setMaxConcurrentJobsOverride( mainObj.value("maxConcurrentJobs").toInt() );
+
+    foreach(QJsonValue job, mainObj.value("jobs").toArray())
+    {
+        QueueItem *item = createItem(job.toObject(), this);
+        if (!item) continue;
+
+        _items << item;
+        _names.insert(item, job.toObject().value("name").toString( QString::number(_items.count()) ));
+        _timers[item].start();
+        connect(item, SIGNAL(statusChanged(MediaUtils::RenderStatus)), this, SLOT(itemStatusChanged(MediaUtils::RenderStatus)));
+    }
+
+    if (_items.count() == 0)
+    {
+        _error = "There's nothing to render in " + _jobFilePath;
+        return false;
+    }
+
+    qInfo().noquote() << "Rendering " + QString::number(_items.count()) + " job(s).";
+
+    RenderQueue::instance()->encode(_items);
+    return true;
+}
+
+QString BatchRunner::error() const
+{
+    return _error;
+}
+
+void BatchRunner::itemStatusChanged(MediaUtils::RenderStatus status)
+{
+    QueueItem *item = qobject_cast<QueueItem *>( sender() );
+    if (!item) return;
+
+    // The timer starts when the item is launched
+    if (status == MediaUtils::Launching) _timers[item].start();
+
+    if (status == MediaUtils::Finished || status == MediaUtils::Stopped || status == MediaUtils::Error)
+    {
+        _durations.insert(item, _timers[item].elapsed());
+        qInfo().noquote() << _names.value(item) + ": " + MediaUtils::RenderStatusToHumanString(status);
+    }
+
+    // Check if all items are done
+    foreach(QueueItem *i, _items)
+    {
+        if (!_durations.contains(i)) return;
+    }
+
+    finish();
+}
+
+QueueItem *BatchRunner::createItem(QJsonObject job, QObject *parent)
+{
+    QueueItem *item = new QueueItem(parent);
+    item->setPriority( job.value("priority").toInt(0) );
+
+    foreach(QJsonValue input, job.value("inputs").toArray())
+    {
+        MediaInfo *m = createInput(input, item);
+        if (m) item->addInputMedia(m);
+    }
+
+    foreach(QJsonValue output, job.value("outputs").toArray())
+    {
+        MediaInfo *m = createOutput(output, item);
+        if (m) item->addOutputMedia(m);
+    }
+
+    if (item->getInputMedias().count() == 0 || item->getOutputMedias().count() == 0)
+    {
+        qWarning().noquote() << "Invalid job, it needs at least one input and one output: " + job.value("name").toString();
+        item->deleteLater();
+        return nullptr;
+    }
+
+    if (job.contains("firstFrame") && job.contains("lastFrame"))
+        setFrameRange(item, job.value("firstFrame").toInt(), job.value("lastFrame").toInt());
+
+    return item;
+}
+
+void BatchRunner::setFrameRange(QueueItem *item, int firstFrame, int lastFrame)
+{
+    foreach(MediaInfo *m, item->getInputMedias())
+    {
+        double framerate = 24.0;
+        if (m->hasVideo() && m->videoStreams().at(0)->framerate() > 0) framerate = m->videoStreams().at(0)->framerate();
+        m->setInPoint( firstFrame / framerate, true );
+        m->setOutPoint( (lastFrame + 1) / framerate, true );
+    }
+
+    foreach(MediaInfo *m, item->getOutputMedias())
+    {
+        if (!m->isSequence() || !m->hasVideo()) continue;
+        m->setStartNumber( m->videoStreams().at(0)->startNumber() + firstFrame, -1, true );
+    }
+}
+
+MediaInfo *BatchRunner::createInput(QJsonValue input, QObject *parent)
+{
+    QJsonObject inputObj;
+    if (input.isString()) inputObj.insert("file", input.toString());
+    else inputObj = input.toObject();
+
+    QFileInfo inputFile( inputObj.value("file").toString() );
+    if (!inputFile.exists())
+    {
+        qWarning().noquote() << "Input file not found: " + inputFile.filePath();
+        return nullptr;
+    }
+
+    MediaInfo *m = new MediaInfo(inputFile, parent);
+    if (m->isAep())
+    {
+        if (inputObj.contains("comp")) m->setAepCompName( inputObj.value("comp").toString() );
+        else if (inputObj.contains("rqItem")) m->setAepRqindex( inputObj.value("rqItem").toInt() );
+        if (inputObj.contains("startFrame")) m->setAepStartFrame( inputObj.value("startFrame").toInt() );
+    }
+    if (inputObj.contains("framerate")) m->setFramerate( inputObj.value("framerate").toDouble() );
+    if (inputObj.contains("colorProfile")) m->setColorProfile( inputObj.value("colorProfile").toString() );
+
+    return m;
+}
+
+MediaInfo *BatchRunner::createOutput(QJsonValue output, QObject *parent)
+{
+    QJsonObject outputObj;
+    if (output.isString()) outputObj.insert("file", output.toString());
+    else outputObj = output.toObject();
+
+    MediaInfo *m = new MediaInfo(parent);
+    m->setOutputMedia(true);
+
+    // The preset can be included in the job file
+    if (outputObj.value("preset").isObject())
+    {
+        m->loadPreset(outputObj.value("preset").toObject(), true);
+    }
+    else
+    {
+        QString preset = presetFile( outputObj.value("preset").toString() );
+        if (preset == "")
+        {
+            qWarning().noquote() << "Preset not found: " + outputObj.value("preset").toString();
+            m->deleteLater();
+            return nullptr;
+        }
+        m->loadPreset(QFileInfo(preset), true);
+    }
+
+    // Set the extension and frame numbers like the output widget does
+    QFileInfo outputFile( outputObj.value("file").toString() );
+    QString fileName = outputFile.filePath();
+    FFMuxer *muxer = m->muxer();
+    if (muxer && outputFile.suffix() == "" && muxer->extensions().count() > 0)
+    {
+        if (muxer->isSequence()) fileName += "_{#####}";
+        fileName += "." + muxer->extensions().at(0);
+    }
+    m->setFileName(fileName, true);
+
+    // Other destinations of the same encode
+    foreach(QJsonValue mirror, outputObj.value("mirrors").toArray())
+    {
+        m->addMirror( mirror.toString(), true );
+    }
+
+    return m;
+}
+
+QString BatchRunner::presetFile(QString preset)
+{
+    if (preset == "") return PresetManager::instance()->defaultPreset().file().absoluteFilePath();
+
+    foreach(Preset p, PresetManager::instance()->presets())
+    {
+        if (p.name() == preset) return p.file().absoluteFilePath();
+    }
+
+    QFileInfo presetFile(preset);
+    if (presetFile.exists()) return presetFile.absoluteFilePath();
+
+    return "";
+}
+
+void BatchRunner::finish()
+{
+    if (_finished) return;
+    _finished = true;
+
+    QJsonArray jobs;
+    int failed = 0;
+    foreach(QueueItem *item, _items)
+    {
+        QJsonObject job;
+        job.insert("name", _names.value(item));
+        job.insert("status", MediaUtils::RenderStatusToHumanString( item->status() ));
+        job.insert("duration", double( _durations.value(item) ) / 1000.0);
+        QJsonArray outputs;
+        foreach(MediaInfo *m, item->getOutputMedias()) outputs.append( m->fileName() );
+        job.insert("outputs", outputs);
+        jobs.append(job);
+
+        if (item->status() != MediaUtils::Finished) failed++;
+    }
+
+    QJsonObject summary;
+    summary.insert("jobs", jobs);
+    summary.insert("succeeded", _items.count() - failed);
+    summary.insert("failed", failed);
+
+    QTextStream out(stdout);
+    out << QJsonDocument(summary).toJson(QJsonDocument::Indented);
+    out.flush();
+
+    QCoreApplication::exit( failed == 0 ? 0 : 1 );
+}
@@ -0,0 +1,105 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QHash>
+#include <QtDebug>
+
+#include "Renderer/renderqueue.h"
+#include "Renderer/presetmanager.h"
+#include "Renderer/queueitem.h"
+
+/**
+ * @brief The BatchRunner class renders a list of jobs described in a JSON file, without any UI.
+ * The job file looks like:
+ * {
+ *     "maxConcurrentJobs": 0,
+ *     "jobs": [
+ *         {
+ *             "name": "Shot 010",
+ *             "priority": 0,
+ *             "inputs": [ "/path/to/frame_0001.exr", { "file": "/path/to/audio.wav", "framerate": 24, "colorProfile": "srgb" } ],
+ *             "outputs": [ { "file": "/path/to/shot010.mp4", "preset": "MP4 - Standard" } ]
+ *         }
+ *     ]
+ * }
+ * An output can also be written to other destinations with "mirrors": [ "/path/to/nas/shot010.mp4" ]; it is encoded only once.
+ * A job can be restricted to a range of frames with "firstFrame" and "lastFrame".
+ * The preset is the name of a preset available in DuME, the path to a preset file, or the content of a preset file (a "dume" object).
+ * The default preset is used if it's omitted.
+ * When all jobs are done, a JSON summary is printed on the standard output and the application quits.
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatchRunner(QString jobFilePath, QObject *parent = nullptr);
+
+    /**
+     * @brief Reads the job file and launches the jobs
+     * @return false if the job file can't be read, or if there's nothing to render
+     */
+    bool start();
+    /**
+     * @brief The error which prevented the jobs from starting
+     * @return
+     */
+    QString error() const;
+
+    /**
+     * @brief Creates a queue item from its description (an object of the "jobs" array)
+     * @param job The description of the job
+     * @param parent The parent of the new item
+     * @return The item, or nullptr if the description is invalid
+     */
+    static QueueItem *createItem(QJsonObject job, QObject *parent = nullptr);
+    /**
+     * @brief Restricts the item to a range of frames: the inputs get in and out points,
+     * and the image sequence outputs are numbered as they would be if the whole item was rendered.
+     * @param item The item
+     * @param firstFrame The first frame, from the start of the inputs (starting at 0)
+     * @param lastFrame The last frame, included
+     */
+    static void setFrameRange(QueueItem *item, int firstFrame, int lastFrame);
+
+private slots:
+    void itemStatusChanged(MediaUtils::RenderStatus status);
+
+private:
+    /**
+     * @brief Creates an input media
+     */
+    static MediaInfo *createInput(QJsonValue input, QObject *parent);
+    /**
+     * @brief Creates an output media
+     */
+    static MediaInfo *createOutput(QJsonValue output, QObject *parent);
+    /**
+     * @brief Gets the preset file from its name or path
+     */
+    static QString presetFile(QString preset);
+    /**
+     * @brief Prints the summary and quits
+     */
+    void finish();
+
+    QString _jobFilePath;
+    QString _error;
+    // The jobs, in the job file order
+    QList<QueueItem *> _items;
+    QHash<QueueItem *, QString> _names;
+    // The time each job has taken
+    QHash<QueueItem *, QElapsedTimer> _timers;
+    QHash<QueueItem *, qint64> _durations;
+    bool _finished;
+};
+
+#endif // BATCHRUNNER_H
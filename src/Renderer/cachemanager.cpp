@@ -1,18 +1,181 @@
 #include "cachemanager.h"
 
+// Temporary folders modified less than this long ago (in seconds) are never removed, they may still be in use
+#define MIN_EVICT_AGE 600
+
 CacheManager::CacheManager(QObject *parent) : QObject(parent)
 {
+    _cacheSize = 0;
+
+    _watcher = new QFileSystemWatcher(this);
+    connect(_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(entriesChanged(QString)));
 
+    _updateTimer = new QTimer(this);
+    _updateTimer->setSingleShot(true);
+    _updateTimer->setInterval(1000);
+    connect(_updateTimer, SIGNAL(timeout()), this, SLOT(update()));
 }
 
 void CacheManager::scan()
 {
-    qint64 c = FileUtils::getDirSize(_rootCacheDir);
-    if (c != _cacheSize)
+    _entrySizes.clear();
+    listEntries(_rootCacheDir);
+    listEntries(_aeCacheDir);
+    listEntries(_segmentsCacheDir);
+    update();
+}
+
+void CacheManager::update()
+{
+    qint64 size = 0;
+    foreach(QString path, _trackers.keys())
     {
-        _cacheSize = c;
+        OutputTracker *tracker = _trackers.value(path);
+        // The temporary folder has been removed
+        if (!QFileInfo::exists(path))
+        {
+            _trackers.remove(path);
+            tracker->deleteLater();
+            // Releases the lock
+            delete _locks.take(path);
+            continue;
+        }
+        tracker->update();
+        size += tracker->size();
+    }
+    foreach(qint64 entrySize, _entrySizes) size += entrySize;
+
+    if (size != _cacheSize)
+    {
+        _cacheSize = size;
         emit cacheSizeChanged(_cacheSize);
     }
+
+    if (maxCacheSize() > 0 && _cacheSize > maxCacheSize()) evict();
+}
+
+void CacheManager::entriesChanged(QString dirPath)
+{
+    listEntries(QDir(dirPath));
+    scheduleUpdate();
+}
+
+void CacheManager::scheduleUpdate()
+{
+    if (!_updateTimer->isActive()) _updateTimer->start();
+}
+
+void CacheManager::track(QString dirPath)
+{
+    OutputTracker *tracker = new OutputTracker(this);
+    tracker->setOutput(dirPath, "*");
+    connect(tracker, SIGNAL(changed()), this, SLOT(scheduleUpdate()));
+    _entrySizes.remove(dirPath);
+    _entryDates.remove(dirPath);
+    _trackers.insert(dirPath, tracker);
+
+    // Tell the other instances of DuME sharing the cache that this folder is in use
+    QLockFile *lock = new QLockFile(dirPath + ".lock");
+    lock->setStaleLockTime(0);
+    if (lock->tryLock(0)) _locks.insert(dirPath, lock);
+    else delete lock;
+}
+
+void CacheManager::listEntries(QDir dir)
+{
+    QSet<QString> found;
+    foreach(QFileInfo entry, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System))
+    {
+        QString path = entry.absoluteFilePath();
+        // These are listed on their own, or updated incrementally
+        if (path == _aeCacheDir.absolutePath() || path == _segmentsCacheDir.absolutePath()) continue;
+        if (_trackers.contains(path)) continue;
+
+        found.insert(path);
+        // Already known and not modified since
+        if (_entrySizes.contains(path) && _entryDates.value(path) == entry.lastModified()) continue;
+
+        if (entry.isDir()) _entrySizes.insert(path, FileUtils::getDirSize( QDir(path) ));
+        else _entrySizes.insert(path, entry.size());
+        _entryDates.insert(path, entry.lastModified());
+    }
+
+    // Forget the entries of this folder which have been removed
+    QString prefix = dir.absolutePath() + "/";
+    foreach(QString path, _entrySizes.keys())
+    {
+        if (!path.startsWith(prefix)) continue;
+        if (path.indexOf("/", prefix.count()) >= 0) continue;
+        if (found.contains(path)) continue;
+        _entrySizes.remove(path);
+        _entryDates.remove(path);
+    }
+}
+
+bool cacheEntrySorter(const QFileInfo &e1, const QFileInfo &e2)
+{
+    return e1.lastModified() < e2.lastModified();
+}
+
+void CacheManager::evict()
+{
+    qint64 maxSize = maxCacheSize();
+
+    // Only the temporary folders which are not used anymore can be removed
+    // (their size is updated by listEntries() when their date changes)
+    QDateTime minDate = QDateTime::currentDateTime().addSecs(-MIN_EVICT_AGE);
+    QList<QFileInfo> entries;
+    QStringList candidates;
+    foreach(QString path, _entrySizes.keys())
+    {
+        QFileInfo entry(path);
+        if (!entry.isDir()) continue;
+        if (!entry.fileName().startsWith("DuME_Cache") && !entry.fileName().startsWith("DuME_Segments")) continue;
+        // Recently used, maybe by another process which does not lock its folders
+        if (entry.lastModified() > minDate) continue;
+        entries << entry;
+        QString locked = QFileInfo::exists(path + ".lock") ? "locked" : "";
+        candidates << path + "|" + QString::number( _entrySizes.value(path) ) + "|" + locked;
+    }
+    candidates.sort();
+    candidates.prepend( QString::number(maxSize) );
+
+    // The last pass could not remove anything, and neither the quota nor the candidates have changed since
+    // (the folders used by this session growing don't make any other folder removable)
+    QString evictionState = candidates.join("\n");
+    if (evictionState == _failedEviction) return;
+
+    std::sort(entries.begin(), entries.end(), cacheEntrySorter);
+
+    bool removed = false;
+    foreach(QFileInfo entry, entries)
+    {
+        if (_cacheSize <= maxSize) break;
+        QString path = entry.absoluteFilePath();
+
+        // Used by another instance of DuME (locks of crashed processes are stale and taken over)
+        QLockFile lock(path + ".lock");
+        lock.setStaleLockTime(0);
+        if (!lock.tryLock(0)) continue;
+
+        qDebug() << "Cache is full, removing " + path;
+        if (QDir(path).removeRecursively())
+        {
+            _cacheSize -= _entrySizes.take(path);
+            _entryDates.remove(path);
+            removed = true;
+        }
+        lock.unlock();
+    }
+
+    if (!removed)
+    {
+        _failedEviction = evictionState;
+        return;
+    }
+    _failedEviction = "";
+
+    emit cacheSizeChanged(_cacheSize);
 }
 
 qint64 CacheManager::cacheSize() const
@@ -20,6 +183,19 @@ qint64 CacheManager::cacheSize() const
     return _cacheSize;
 }
 
+qint64 CacheManager::maxCacheSize() const
+{
+    QSettings settings;
+    return settings.value("cache/maxSize", 0).toLongLong();
+}
+
+void CacheManager::setMaxCacheSize(qint64 size)
+{
+    QSettings settings;
+    settings.setValue("cache/maxSize", size);
+    update();
+}
+
 CacheManager *CacheManager::instance()
 {
     if (!_instance) _instance = new CacheManager();
@@ -38,9 +214,7 @@ void CacheManager::init()
 
     setRootCacheDir( currentCachePath, false );
 
-    _scanTimer = new QTimer(this);
-    connect(_scanTimer, SIGNAL(timeout()), this, SLOT(scan()));
-    _scanTimer->start(5000);
+    ProbeCache::instance()->evict();
 }
 
 QDir CacheManager::getRootCacheDir() const
@@ -50,7 +224,13 @@ QDir CacheManager::getRootCacheDir() const
 
 void CacheManager::setRootCacheDir(QString path, bool purge)
 {
-    if (purge) purgeCache();
+    if (purge)
+    {
+        purgeCache();
+        // The probe cache moves with the root dir
+        ProbeCache::instance()->clear();
+        _rootCacheDir.rmdir("probeCache");
+    }
 
     //root
     _rootCacheDir = QDir(path);
@@ -60,13 +240,46 @@ void CacheManager::setRootCacheDir(QString path, bool purge)
     _aeCacheDir = QDir( _rootCacheDir.path() + "/aeCache" );
     if (!_aeCacheDir.exists()) _aeCacheDir.mkpath(".");
 
+    //segments cache
+    _segmentsCacheDir = QDir( _rootCacheDir.path() + "/segmentsCache" );
+    if (!_segmentsCacheDir.exists()) _segmentsCacheDir.mkpath(".");
+
+    //probe cache
+    ProbeCache::instance()->setCacheDir( _rootCacheDir.path() + "/probeCache" );
+
+    //extracted LUTs
+    LutCache::instance()->setCacheDir( _rootCacheDir.path() + "/luts" );
+
      QSettings settings;
      settings.setValue("cachePath", path);
+
+    // Watch the new folders
+    if (_watcher->directories().count() > 0) _watcher->removePaths( _watcher->directories() );
+    _watcher->addPath( _rootCacheDir.absolutePath() );
+    _watcher->addPath( _aeCacheDir.absolutePath() );
+    _watcher->addPath( _segmentsCacheDir.absolutePath() );
+
+    qDeleteAll(_trackers);
+    _trackers.clear();
+    qDeleteAll(_locks);
+    _locks.clear();
+    track( ProbeCache::instance()->cacheDir().absolutePath() );
+
+    scan();
 }
 
 void CacheManager::purgeCache()
 {
-    _rootCacheDir.removeRecursively();
+    // The LUTs will be extracted again
+    LutCache::instance()->clear();
+
+    // Keep the probe cache, it's meant to persist between sessions
+    foreach(QFileInfo entry, _rootCacheDir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden))
+    {
+        if (entry.absoluteFilePath() == ProbeCache::instance()->cacheDir().absolutePath()) continue;
+        if (entry.isDir()) QDir(entry.absoluteFilePath()).removeRecursively();
+        else QFile::remove(entry.absoluteFilePath());
+    }
 }
 
 QDir CacheManager::aeCacheDir() const
@@ -76,7 +289,22 @@ QDir CacheManager::aeCacheDir() const
 
 QTemporaryDir *CacheManager::getAeTempDir()
 {
-    return new QTemporaryDir( _aeCacheDir.absolutePath() + "/DuME_Cache" );
+    QTemporaryDir *dir = new QTemporaryDir( _aeCacheDir.absolutePath() + "/DuME_Cache" );
+    if (dir->isValid()) track( dir->path() );
+    return dir;
+}
+
+QDir CacheManager::segmentsCacheDir() const
+{
+    return _segmentsCacheDir;
+}
+
+QTemporaryDir *CacheManager::getSegmentsTempDir()
+{
+    if (!_segmentsCacheDir.exists()) _segmentsCacheDir.mkpath(".");
+    QTemporaryDir *dir = new QTemporaryDir( _segmentsCacheDir.absolutePath() + "/DuME_Segments" );
+    if (dir->isValid()) track( dir->path() );
+    return dir;
 }
 
 CacheManager *CacheManager::_instance = nullptr;
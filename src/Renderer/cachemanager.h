@@ -2,6 +2,9 @@
 #define CACHEMANAGER_H
 
 #include "duqf-utils/utils.h"
+#include "Renderer/probecache.h"
+#include "Renderer/lutcache.h"
+#include "Renderer/outputtracker.h"
 
 #include <QObject>
 #include <QApplication>
@@ -11,6 +14,11 @@
 #include <QFile>
 #include <QtDebug>
 #include <QTimer>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
+#include <QLockFile>
+#include <QDateTime>
 
 class CacheManager : public QObject
 {
@@ -21,26 +29,78 @@ public:
     void init();
     QDir aeCacheDir() const;
     QTemporaryDir *getAeTempDir();
+    QDir segmentsCacheDir() const;
+    QTemporaryDir *getSegmentsTempDir();
     qint64 cacheSize() const;
+    /**
+     * @brief The maximum size of the cache, in Bytes. 0 if unlimited.
+     * When the cache is bigger, the oldest temporary folders which are not used anymore are removed.
+     */
+    qint64 maxCacheSize() const;
+    void setMaxCacheSize(qint64 size);
 
 public slots:
     void setRootCacheDir(QString path, bool purge = true);
     void purgeCache();
+    /**
+     * @brief Computes the size of the whole cache. This walks the entire cache tree: the size is then updated incrementally.
+     */
     void scan();
+    /**
+     * @brief Updates the size of the cache with the changes since the last update, and removes old folders if it's too big
+     */
+    void update();
 
 signals:
-    void cacheSizeChanged(int);
+    void cacheSizeChanged(qint64);
+
+private slots:
+    // An entry has been added or removed from one of the cache folders
+    void entriesChanged(QString dirPath);
+    // Updates the size a bit later, to group the changes
+    void scheduleUpdate();
 
 private:
     //private constructor, this is a singleton
     explicit CacheManager(QObject *parent = nullptr);
     /**
-     * @brief A timer to regularly scan the cache (and know its size)
+     * @brief Keeps track of the size of a folder being used in this session, and locks it so that other instances don't remove it
+     * @param dirPath The folder
+     */
+    void track(QString dirPath);
+    /**
+     * @brief Lists the entries of a cache folder, and gets the size of the new ones
+     * @param dir The folder
+     */
+    void listEntries(QDir dir);
+    /**
+     * @brief Removes the least recently modified temporary folders until the cache is smaller than its maximum size.
+     * Folders locked by another instance of DuME, or modified recently, are kept.
+     */
+    void evict();
+
+    /**
+     * @brief Groups the updates
+     */
+    QTimer *_updateTimer;
+    /**
+     * @brief Watches the root, aeCache and segmentsCache folders for new and removed entries
      */
-    QTimer *_scanTimer;
+    QFileSystemWatcher *_watcher;
     QDir _rootCacheDir;
     QDir _aeCacheDir;
+    QDir _segmentsCacheDir;
     qint64 _cacheSize;
+    // The size of the entries which are not being used (left by previous sessions, LUTs...)
+    QHash<QString, qint64> _entrySizes;
+    // The modification date of these entries when their size was computed
+    QHash<QString, QDateTime> _entryDates;
+    // The folders used in this session, and the probe cache, updated incrementally
+    QHash<QString, OutputTracker *> _trackers;
+    // The locks of the folders used in this session
+    QHash<QString, QLockFile *> _locks;
+    // The quota and candidates of the last eviction which could not remove anything, not to try again until they change
+    QString _failedEviction;
 
 protected:
     static CacheManager *_instance;
@@ -0,0 +1,186 @@
+#include "farmcoordinator.h"
+
+// Milliseconds between two checks of the units while merging
+#define CHECK_INTERVAL 2000
+
+FarmCoordinator::FarmCoordinator(QString farmPath, QObject *parent) : QObject(parent)
+{
+    _farmPath = farmPath;
+    _error = "";
+
+    _checkTimer = new QTimer(this);
+    _checkTimer->setInterval(CHECK_INTERVAL);
+    connect(_checkTimer, SIGNAL(timeout()), this, SLOT(checkUnits()));
+}
+
+int FarmCoordinator::submit(QString jobFilePath, int framesPerUnit)
+{
+    if (!FarmNode::createDirs(_farmPath))
+    {
+        _error = "Cannot use the farm folder: " + _farmPath;
+        return -1;
+    }
+
+    QFile jobFile(jobFilePath);
+    if (!jobFile.open(QIODevice::ReadOnly))
+    {
+        _error = "Cannot read the job file: " + jobFilePath;
+        return -1;
+    }
+    QJsonParseError parseError;
+    QJsonDocument jobDoc = QJsonDocument::fromJson(jobFile.readAll(), &parseError);
+    jobFile.close();
+    if (!jobDoc.isObject())
+    {
+        _error = "Invalid job file: " + parseError.errorString();
+        return -1;
+    }
+
+    // The units are claimed in the order of their names
+    QString submission = QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz");
+    int numUnits = 0;
+    int jobIndex = 0;
+
+    foreach(QJsonValue jobValue, jobDoc.object().value("jobs").toArray())
+    {
+        QJsonObject job = jobValue.toObject();
+        jobIndex++;
+        QString unitPrefix = submission + "_" + QString("%1").arg(jobIndex, 4, 10, QChar('0'));
+        job.insert("farmJob", job.value("name").toString( unitPrefix ));
+
+        int frames = framesPerUnit > 0 ? numFrames(job) : 0;
+        if (frames <= framesPerUnit)
+        {
+            if (queueUnit(unitPrefix, job)) numUnits++;
+            continue;
+        }
+
+        int part = 0;
+        for (int first = 0; first < frames; first += framesPerUnit)
+        {
+            part++;
+            QJsonObject unitObj = job;
+            unitObj.insert("firstFrame", first);
+            unitObj.insert("lastFrame", std::min(first + framesPerUnit, frames) - 1);
+            if (queueUnit(unitPrefix + "_" + QString("%1").arg(part, 4, 10, QChar('0')), unitObj)) numUnits++;
+        }
+    }
+
+    qInfo().noquote() << QString::number(numUnits) + " work unit(s) queued in " + _farmPath;
+    return numUnits;
+}
+
+void FarmCoordinator::merge()
+{
+    qInfo().noquote() << "Waiting for the work units in " + _farmPath;
+    _checkTimer->start();
+    checkUnits();
+}
+
+QString FarmCoordinator::error() const
+{
+    return _error;
+}
+
+void FarmCoordinator::checkUnits()
+{
+    QStringList filter("*.json");
+    if (FarmNode::unitsDir(_farmPath, FarmNode::Queued).entryList(filter, QDir::Files).count() > 0) return;
+    if (FarmNode::unitsDir(_farmPath, FarmNode::Running).entryList(filter, QDir::Files).count() > 0) return;
+
+    _checkTimer->stop();
+
+    // Group the units by job; the ranges of frames are rendered directly in the final sequence
+    QMap<QString, QJsonObject> jobs;
+    int failed = 0;
+
+    QList<FarmNode::UnitState> states;
+    states << FarmNode::Done << FarmNode::Failed;
+    foreach(FarmNode::UnitState state, states)
+    {
+        QDir dir = FarmNode::unitsDir(_farmPath, state);
+        foreach(QString unitFile, dir.entryList(filter, QDir::Files, QDir::Name))
+        {
+            QFile f(dir.absoluteFilePath(unitFile));
+            if (!f.open(QIODevice::ReadOnly)) continue;
+            QJsonObject unitObj = QJsonDocument::fromJson(f.readAll()).object();
+            f.close();
+
+            QString jobName = unitObj.value("farmJob").toString( unitFile );
+            QJsonObject job = jobs.value(jobName);
+            if (job.isEmpty())
+            {
+                job.insert("name", jobName);
+                job.insert("status", MediaUtils::RenderStatusToHumanString(MediaUtils::Finished));
+                QJsonArray outputs;
+                foreach(QJsonValue output, unitObj.value("outputs").toArray())
+                {
+                    if (output.isString()) outputs.append(output);
+                    else outputs.append( output.toObject().value("file") );
+                }
+                job.insert("outputs", outputs);
+            }
+
+            job.insert("units", job.value("units").toInt() + 1);
+            job.insert("duration", job.value("duration").toDouble() + unitObj.value("duration").toDouble());
+            if (state == FarmNode::Failed)
+            {
+                if (job.value("failedUnits").toInt() == 0) failed++;
+                job.insert("failedUnits", job.value("failedUnits").toInt() + 1);
+                job.insert("status", MediaUtils::RenderStatusToHumanString(MediaUtils::Error));
+            }
+            jobs.insert(jobName, job);
+        }
+    }
+
+    QJsonArray jobsArray;
+    foreach(QJsonObject job, jobs.values()) jobsArray.append(job);
+
+    QJsonObject summary;
+    summary.insert("jobs", jobsArray);
+    summary.insert("succeeded", jobs.count() - failed);
+    summary.insert("failed", failed);
+
+    QTextStream out(stdout);
+    out << QJsonDocument(summary).toJson(QJsonDocument::Indented);
+    out.flush();
+
+    QCoreApplication::exit( failed == 0 ? 0 : 1 );
+}
+
+int FarmCoordinator::numFrames(QJsonObject job)
+{
+    QueueItem *item = BatchRunner::createItem(job);
+    if (!item) return 0;
+
+    int frames = 0;
+    bool sequences = true;
+    foreach(MediaInfo *m, item->getOutputMedias())
+    {
+        if (!m->isSequence()) sequences = false;
+    }
+
+    // Only image sequences can be rendered by several nodes
+    if (sequences)
+    {
+        foreach(MediaInfo *m, item->getInputMedias())
+        {
+            if (!m->hasVideo()) continue;
+            if (m->isSequence()) frames = m->frames().count();
+            else frames = int( m->duration() * m->videoStreams().at(0)->framerate() );
+            break;
+        }
+    }
+
+    delete item;
+    return frames;
+}
+
+bool FarmCoordinator::queueUnit(QString unit, QJsonObject unitObj)
+{
+    // Written in a temporary file and renamed: the nodes never read partial units
+    QSaveFile unitFile( FarmNode::unitsDir(_farmPath, FarmNode::Queued).absoluteFilePath(unit + ".json") );
+    if (!unitFile.open(QIODevice::WriteOnly)) return false;
+    unitFile.write( QJsonDocument(unitObj).toJson() );
+    return unitFile.commit();
+}
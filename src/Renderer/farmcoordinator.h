@@ -0,0 +1,68 @@
+#ifndef FARMCOORDINATOR_H
+#define FARMCOORDINATOR_H
+
+#include <QObject>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTextStream>
+#include <QTimer>
+#include <QMap>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "Renderer/farmnode.h"
+
+/**
+ * @brief The FarmCoordinator class submits jobs to a farm folder, and merges the results of the work units.
+ * Jobs whose outputs are all image sequences can be split in ranges of frames rendered by different nodes.
+ */
+class FarmCoordinator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FarmCoordinator(QString farmPath, QObject *parent = nullptr);
+
+    /**
+     * @brief Splits the jobs of a job file in work units, and queues them in the farm folder
+     * @param jobFilePath The job file, as used by the BatchRunner
+     * @param framesPerUnit The number of frames of each unit when the job can be split, 0 to render whole jobs
+     * @return The number of queued units, -1 if the job file can't be read
+     */
+    int submit(QString jobFilePath, int framesPerUnit = 0);
+    /**
+     * @brief Waits for all the units in the farm to be done, prints a JSON summary of the jobs, and quits
+     */
+    void merge();
+    /**
+     * @brief The error which prevented the jobs from being submitted
+     * @return
+     */
+    QString error() const;
+
+private slots:
+    // Checks if there are still units to render
+    void checkUnits();
+
+private:
+    /**
+     * @brief The number of frames of the job, 0 if it can't be split
+     */
+    int numFrames(QJsonObject job);
+    /**
+     * @brief Writes a unit in the queue
+     */
+    bool queueUnit(QString unit, QJsonObject unitObj);
+
+    QString _farmPath;
+    QString _error;
+    QTimer *_checkTimer;
+};
+
+#endif // FARMCOORDINATOR_H
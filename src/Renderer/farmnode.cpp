@@ -0,0 +1,226 @@
+#include "farmnode.h"
+
+// Milliseconds between two checks of the queue
+#define POLL_INTERVAL 2000
+// Milliseconds between two renewals of the leases
+#define HEARTBEAT_INTERVAL 10000
+// A lease which has not been renewed for this long (in ms) has expired
+#define LEASE_TIMEOUT 60000
+
+FarmNode::FarmNode(QString farmPath, QObject *parent) : QObject(parent)
+{
+    _farmPath = farmPath;
+    _nodeName = QSysInfo::machineHostName() + "-" + QString::number( QCoreApplication::applicationPid() );
+    // The name is used in file names
+    _nodeName.replace("@", "_");
+    _error = "";
+
+    _pollTimer = new QTimer(this);
+    _pollTimer->setInterval(POLL_INTERVAL);
+    connect(_pollTimer, SIGNAL(timeout()), this, SLOT(poll()));
+
+    _heartbeatTimer = new QTimer(this);
+    _heartbeatTimer->setInterval(HEARTBEAT_INTERVAL);
+    connect(_heartbeatTimer, SIGNAL(timeout()), this, SLOT(heartbeat()));
+}
+
+bool FarmNode::start()
+{
+    if (!createDirs(_farmPath))
+    {
+        _error = "Cannot use the farm folder: " + _farmPath;
+        return false;
+    }
+
+    qInfo().noquote() << "Farm node " + _nodeName + " waiting for work units in " + _farmPath;
+
+    _pollTimer->start();
+    _heartbeatTimer->start();
+    poll();
+    return true;
+}
+
+QString FarmNode::error() const
+{
+    return _error;
+}
+
+QString FarmNode::nodeName() const
+{
+    return _nodeName;
+}
+
+QDir FarmNode::unitsDir(QString farmPath, FarmNode::UnitState state)
+{
+    if (state == Queued) return QDir(farmPath + "/queued");
+    if (state == Running) return QDir(farmPath + "/running");
+    if (state == Done) return QDir(farmPath + "/done");
+    return QDir(farmPath + "/failed");
+}
+
+bool FarmNode::createDirs(QString farmPath)
+{
+    QDir farmDir(farmPath);
+    return farmDir.mkpath("queued") && farmDir.mkpath("running") && farmDir.mkpath("done") && farmDir.mkpath("failed");
+}
+
+void FarmNode::poll()
+{
+    expireLeases();
+
+    // Claim a new unit only when the render queue has started all the previous ones,
+    // so that the concurrency is still handled by the queue
+    foreach(QueueItem *item, _units.keys())
+    {
+        if (item->status() == MediaUtils::Waiting) return;
+    }
+
+    claimUnit();
+}
+
+void FarmNode::heartbeat()
+{
+    QDir runningDir = unitsDir(_farmPath, Running);
+    foreach(QString unit, _units.values())
+    {
+        writeLease( runningDir.absoluteFilePath(unit + "@" + _nodeName + ".lease") );
+    }
+}
+
+void FarmNode::itemStatusChanged(MediaUtils::RenderStatus status)
+{
+    QueueItem *item = qobject_cast<QueueItem *>( sender() );
+    if (!item || !_units.contains(item)) return;
+
+    if (status == MediaUtils::Finished || status == MediaUtils::Stopped || status == MediaUtils::Error)
+    {
+        releaseUnit(item, status);
+        // There may be something else to do right now
+        poll();
+    }
+}
+
+void FarmNode::expireLeases()
+{
+    QDir runningDir = unitsDir(_farmPath, Running);
+    QDir queuedDir = unitsDir(_farmPath, Queued);
+    QDateTime now = QDateTime::currentDateTime();
+
+    foreach(QString unitFile, runningDir.entryList(QStringList("*.json"), QDir::Files))
+    {
+        QString baseName = unitFile.left( unitFile.count() - 5 );
+        int sep = baseName.lastIndexOf("@");
+        if (sep < 0) continue;
+        QString unit = baseName.left(sep);
+        if (_units.values().contains(unit) && baseName.mid(sep+1) == _nodeName) continue;
+
+        // The lease is written before the unit is claimed, a missing lease means the unit has been released
+        QFileInfo lease( runningDir.absoluteFilePath(baseName + ".lease") );
+        if (lease.exists() && lease.lastModified().msecsTo(now) < LEASE_TIMEOUT) continue;
+
+        // Only one node can succeed
+        if (QFile::rename( runningDir.absoluteFilePath(unitFile), queuedDir.absoluteFilePath(unit + ".json") ))
+        {
+            QFile::remove( lease.absoluteFilePath() );
+            qInfo().noquote() << "The lease of " + baseName.mid(sep+1) + " on " + unit + " has expired, the unit is queued again.";
+        }
+    }
+}
+
+bool FarmNode::claimUnit()
+{
+    QDir queuedDir = unitsDir(_farmPath, Queued);
+    QDir runningDir = unitsDir(_farmPath, Running);
+
+    // The unit names start with the submission date, this is a FIFO
+    QStringList units = queuedDir.entryList(QStringList("*.json"), QDir::Files, QDir::Name);
+    foreach(QString unitFile, units)
+    {
+        QString unit = unitFile.left( unitFile.count() - 5 );
+        QString runningPath = runningDir.absoluteFilePath(unit + "@" + _nodeName + ".json");
+        QString leasePath = runningDir.absoluteFilePath(unit + "@" + _nodeName + ".lease");
+
+        if (!writeLease(leasePath)) return false;
+        // Atomic: if another node has been faster, try the next one
+        if (!QFile::rename( queuedDir.absoluteFilePath(unitFile), runningPath ))
+        {
+            QFile::remove(leasePath);
+            continue;
+        }
+
+        QFile f(runningPath);
+        QJsonObject unitObj;
+        if (f.open(QIODevice::ReadOnly))
+        {
+            unitObj = QJsonDocument::fromJson(f.readAll()).object();
+            f.close();
+        }
+
+        QueueItem *item = BatchRunner::createItem(unitObj, this);
+        if (!item)
+        {
+            // Put it in the failed folder right away
+            QJsonObject result = unitObj;
+            result.insert("node", _nodeName);
+            result.insert("status", MediaUtils::RenderStatusToHumanString(MediaUtils::Error));
+            result.insert("error", "Invalid work unit");
+            QSaveFile resultFile( unitsDir(_farmPath, Failed).absoluteFilePath(unit + ".json") );
+            if (resultFile.open(QIODevice::WriteOnly))
+            {
+                resultFile.write( QJsonDocument(result).toJson() );
+                resultFile.commit();
+            }
+            QFile::remove(runningPath);
+            QFile::remove(leasePath);
+            continue;
+        }
+
+        qInfo().noquote() << "Claimed " + unit;
+
+        _units.insert(item, unit);
+        _unitObjects.insert(item, unitObj);
+        _timers[item].start();
+        connect(item, SIGNAL(statusChanged(MediaUtils::RenderStatus)), this, SLOT(itemStatusChanged(MediaUtils::RenderStatus)));
+        RenderQueue::instance()->encode(item);
+        return true;
+    }
+
+    return false;
+}
+
+bool FarmNode::writeLease(QString leasePath)
+{
+    // Rewriting the file updates its modification date
+    QFile lease(leasePath);
+    if (!lease.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    lease.write( (_nodeName + "\n" + QDateTime::currentDateTime().toString(Qt::ISODate) + "\n").toUtf8() );
+    lease.close();
+    return true;
+}
+
+void FarmNode::releaseUnit(QueueItem *item, MediaUtils::RenderStatus status)
+{
+    QString unit = _units.take(item);
+    QJsonObject result = _unitObjects.take(item);
+    qint64 duration = _timers.take(item).elapsed();
+
+    result.insert("node", _nodeName);
+    result.insert("status", MediaUtils::RenderStatusToHumanString(status));
+    result.insert("duration", double(duration) / 1000.0);
+
+    UnitState state = status == MediaUtils::Finished ? Done : Failed;
+    QSaveFile resultFile( unitsDir(_farmPath, state).absoluteFilePath(unit + ".json") );
+    if (resultFile.open(QIODevice::WriteOnly))
+    {
+        resultFile.write( QJsonDocument(result).toJson() );
+        resultFile.commit();
+    }
+
+    QDir runningDir = unitsDir(_farmPath, Running);
+    QFile::remove( runningDir.absoluteFilePath(unit + "@" + _nodeName + ".json") );
+    QFile::remove( runningDir.absoluteFilePath(unit + "@" + _nodeName + ".lease") );
+
+    qInfo().noquote() << unit + ": " + MediaUtils::RenderStatusToHumanString(status);
+
+    item->deleteLater();
+}
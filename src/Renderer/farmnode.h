@@ -0,0 +1,107 @@
+#ifndef FARMNODE_H
+#define FARMNODE_H
+
+#include <QObject>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSysInfo>
+#include <QTimer>
+#include <QHash>
+#include <QtDebug>
+
+#include "Renderer/renderqueue.h"
+#include "Renderer/batchrunner.h"
+
+/**
+ * @brief The FarmNode class renders work units from a farm folder shared by several nodes.
+ * The farm folder contains:
+ * - queued/unit.json: the units waiting for a node. A unit is a job, as in the BatchRunner job files, possibly with a range of frames.
+ * - running/unit@node.json: the units being rendered. A node claims a unit by renaming it, which is atomic.
+ * - running/unit@node.lease: the lease of the node on the unit, rewritten regularly while rendering.
+ * When a lease has expired (the node has crashed or has been disconnected), any other node puts the unit back in the queue.
+ * - done/unit.json and failed/unit.json: the units which have been rendered, with the result.
+ */
+class FarmNode : public QObject
+{
+    Q_OBJECT
+public:
+    enum UnitState { Queued, Running, Done, Failed };
+    Q_ENUM(UnitState)
+
+    explicit FarmNode(QString farmPath, QObject *parent = nullptr);
+
+    /**
+     * @brief Creates the farm folders if needed and starts looking for work units
+     * @return false if the farm folder can't be used
+     */
+    bool start();
+    /**
+     * @brief The error which prevented the node from starting
+     * @return
+     */
+    QString error() const;
+    /**
+     * @brief The unique name of this node, made of the host name and the process id
+     * @return
+     */
+    QString nodeName() const;
+
+    /**
+     * @brief The folder containing the units in the given state
+     * @param farmPath The farm folder
+     * @param state The state of the units
+     * @return
+     */
+    static QDir unitsDir(QString farmPath, UnitState state);
+    /**
+     * @brief Creates the farm folders
+     * @return false if they can't be created
+     */
+    static bool createDirs(QString farmPath);
+
+private slots:
+    // Looks for expired leases and new units
+    void poll();
+    // Rewrites the leases of the units being rendered
+    void heartbeat();
+    void itemStatusChanged(MediaUtils::RenderStatus status);
+
+private:
+    /**
+     * @brief Puts back in the queue the units whose node doesn't renew its lease
+     */
+    void expireLeases();
+    /**
+     * @brief Claims the next unit in the queue and renders it
+     * @return false if there was nothing to claim
+     */
+    bool claimUnit();
+    /**
+     * @brief Writes the lease of a unit
+     */
+    bool writeLease(QString leasePath);
+    /**
+     * @brief Moves the unit to the done or failed folder, with the result
+     */
+    void releaseUnit(QueueItem *item, MediaUtils::RenderStatus status);
+
+    QString _farmPath;
+    QString _nodeName;
+    QString _error;
+    QTimer *_pollTimer;
+    QTimer *_heartbeatTimer;
+    // The units being rendered by this node, by item
+    QHash<QueueItem *, QString> _units;
+    QHash<QueueItem *, QJsonObject> _unitObjects;
+    QHash<QueueItem *, QElapsedTimer> _timers;
+};
+
+#endif // FARMNODE_H
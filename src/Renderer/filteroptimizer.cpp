@@ -0,0 +1,312 @@
+#include "filteroptimizer.h"
+
+FilterOptimizer::FilterOptimizer(QSize sourceSize, QString sourceCrop)
+{
+    _sourceSize = sourceSize;
+    _sourceCrop = sourceCrop;
+}
+
+QStringList FilterOptimizer::optimize(QStringList filterChain)
+{
+    _changes.clear();
+    _resizeCrops.clear();
+
+    QStringList filters;
+    foreach(QString filter, filterChain)
+    {
+        if (filter == "") continue;
+        if (isIdentity(filter, sizeAt(filters, filters.count())))
+        {
+            _changes << "Removed (no change): " + filter;
+            continue;
+        }
+        filters << filter;
+    }
+
+    fuseResize(filters);
+    moveDownscale(filters);
+
+    return filters;
+}
+
+QStringList FilterOptimizer::changes() const
+{
+    return _changes;
+}
+
+QList<QStringList> FilterOptimizer::parseFilter(QString filter, QString &name)
+{
+    QList<QStringList> opts;
+    name = filter.section("=", 0, 0);
+    if (name == filter) return opts;
+
+    QString args = filter.mid(name.length() + 1);
+    QStringList opt;
+    QString word = "";
+    bool quoted = false;
+    for (int i = 0; i < args.length(); i++)
+    {
+        QChar c = args.at(i);
+        if (c == '\\' && i + 1 < args.length())
+        {
+            i++;
+            word += args.at(i);
+        }
+        else if (c == '\'') quoted = !quoted;
+        else if (c == '=' && !quoted && opt.count() == 0)
+        {
+            opt << word;
+            word = "";
+        }
+        else if (c == ':' && !quoted)
+        {
+            opts << ( QStringList(opt) << word );
+            opt.clear();
+            word = "";
+        }
+        else word += c;
+    }
+    opts << ( QStringList(opt) << word );
+
+    return opts;
+}
+
+QHash<QString, QString> FilterOptimizer::options(QString filter, QString &name, QStringList positionalNames)
+{
+    QHash<QString, QString> opts;
+    int position = 0;
+    foreach(QStringList opt, parseFilter(filter, name))
+    {
+        if (opt.count() == 2) opts.insert(opt[0], opt[1]);
+        else if (position < positionalNames.count()) opts.insert(positionalNames.at(position++), opt[0]);
+        // Unknown positional option, keep it so that the filter is not taken for something else
+        else opts.insert("#" + QString::number(position++), opt[0]);
+    }
+    return opts;
+}
+
+bool FilterOptimizer::isIdentity(QString filter, QSize size)
+{
+    QString name;
+    QHash<QString, QString> opts = options(filter, name);
+
+    if (name == "zscale" || name == "colorspace")
+    {
+        // output option -> input option
+        QHash<QString, QString> pairs;
+        if (name == "zscale")
+        {
+            pairs.insert("transfer", "transferin");
+            pairs.insert("primaries", "primariesin");
+            pairs.insert("matrix", "matrixin");
+            pairs.insert("range", "rangein");
+        }
+        else
+        {
+            pairs.insert("trc", "itrc");
+            pairs.insert("primaries", "iprimaries");
+            pairs.insert("space", "ispace");
+            pairs.insert("range", "irange");
+        }
+
+        QHashIterator<QString, QString> it(opts);
+        while (it.hasNext())
+        {
+            it.next();
+            QString key = it.key();
+            if (key == "dither") continue;
+            // Converting from the frame metadata
+            if (pairs.contains(key))
+            {
+                if (opts.value(pairs.value(key)) != it.value()) return false;
+            }
+            else if (!pairs.values().contains(key)) return false;
+        }
+        return true;
+    }
+
+    if (name == "lutrgb")
+    {
+        QRegularExpression reGamma("^gammaval\\(\\s*([\\d.]+)\\s*(?:/\\s*([\\d.]+)\\s*)?\\)$");
+        QHashIterator<QString, QString> it(opts);
+        while (it.hasNext())
+        {
+            it.next();
+            if (it.key() != "r" && it.key() != "g" && it.key() != "b") return false;
+            QRegularExpressionMatch match = reGamma.match(it.value().trimmed());
+            if (!match.hasMatch()) return false;
+            double gamma = match.captured(1).toDouble();
+            if (match.captured(2) != "") gamma /= match.captured(2).toDouble();
+            if (gamma != 1.0) return false;
+        }
+        return true;
+    }
+
+    if (name == "scale" && size.isValid())
+    {
+        opts = options(filter, name, QStringList() << "w" << "h");
+        QHashIterator<QString, QString> it(opts);
+        while (it.hasNext())
+        {
+            it.next();
+            if (it.key() != "w" && it.key() != "h" && it.key() != "flags" && it.key() != "force_original_aspect_ratio") return false;
+        }
+        return dimension(opts.value("w"), size) == size.width() && dimension(opts.value("h"), size) == size.height();
+    }
+
+    return false;
+}
+
+void FilterOptimizer::fuseResize(QStringList &filterChain)
+{
+    for (int i = 0; i < filterChain.count() - 1; i++)
+    {
+        QString scaleName;
+        QHash<QString, QString> scaleOpts = options(filterChain.at(i), scaleName, QStringList() << "w" << "h");
+        if (scaleName != "scale") continue;
+
+        QString aspectMode = scaleOpts.value("force_original_aspect_ratio");
+        if (aspectMode != "increase" && aspectMode != "decrease") continue;
+
+        QSize size = sizeAt(filterChain, i);
+        int w = dimension(scaleOpts.value("w"), size);
+        int h = dimension(scaleOpts.value("h"), size);
+        if (w <= 0 || h <= 0) continue;
+
+        QString nextName;
+        QHash<QString, QString> nextOpts = options(filterChain.at(i + 1), nextName, QStringList() << "w" << "h" << "x" << "y");
+        if (dimension(nextOpts.value("w"), size) != w || dimension(nextOpts.value("h"), size) != h) continue;
+
+        QString scale = "scale=" + QString::number(w) + ":" + QString::number(h);
+        if (scaleOpts.contains("flags")) scale += ":flags=" + scaleOpts.value("flags");
+
+        bool sameAspect = size.isValid() && qint64(w) * size.height() == qint64(h) * size.width();
+
+        if (aspectMode == "increase" && nextName == "crop" && nextOpts.count() == 2)
+        {
+            QString original = filterChain.at(i) + "," + filterChain.at(i + 1);
+            filterChain.removeAt(i + 1);
+            filterChain[i] = scale;
+            // Crop first (crop does not copy the frame), so that fewer pixels are scaled
+            if (!sameAspect)
+            {
+                QString ws = QString::number(w);
+                QString hs = QString::number(h);
+                QString crop = "crop='min(iw,ih*" + ws + "/" + hs + ")':'min(ih,iw*" + hs + "/" + ws + ")'";
+                filterChain.insert(i, crop);
+                _resizeCrops << crop;
+                i++;
+            }
+            _changes << "Crop before scaling: " + original;
+        }
+        else if (aspectMode == "decrease" && nextName == "pad" && sameAspect)
+        {
+            _changes << "Removed empty padding: " + filterChain.at(i) + "," + filterChain.at(i + 1);
+            filterChain.removeAt(i + 1);
+            filterChain[i] = scale;
+        }
+    }
+}
+
+void FilterOptimizer::moveDownscale(QStringList &filterChain)
+{
+    // Find the resize
+    int scaleIndex = -1;
+    QHash<QString, QString> scaleOpts;
+    for (int i = 0; i < filterChain.count(); i++)
+    {
+        QString name;
+        scaleOpts = options(filterChain.at(i), name, QStringList() << "w" << "h");
+        if (name != "scale") continue;
+        scaleIndex = i;
+        break;
+    }
+    if (scaleIndex < 0) return;
+
+    int first = scaleIndex;
+    if (first > 0 && _resizeCrops.contains(filterChain.at(first - 1))) first--;
+
+    // Only if the frames get smaller
+    QSize size = sizeAt(filterChain, first);
+    if (!size.isValid()) return;
+    if (scaleOpts.value("force_original_aspect_ratio") == "increase") return;
+    int w = dimension(scaleOpts.value("w"), size);
+    int h = dimension(scaleOpts.value("h"), size);
+    if (w <= 0 || h <= 0) return;
+    if (qint64(w) * h >= qint64(size.width()) * size.height()) return;
+
+    // Per-pixel and temporal filters don't depend on the size of the frames
+    QStringList movable;
+    movable << "lutrgb" << "lut1d" << "lut3d" << "colorspace" << "zscale" << "minterpolate" << "setpts";
+
+    int target = first;
+    while (target > 0)
+    {
+        QString name;
+        QHash<QString, QString> opts = options(filterChain.at(target - 1), name);
+        if (!movable.contains(name)) break;
+        // zscale may resize too
+        if (name == "zscale" && (opts.contains("w") || opts.contains("h") || opts.contains("width") || opts.contains("height") || opts.contains("size") || opts.contains("s"))) break;
+        target--;
+    }
+    if (target == first) return;
+
+    _changes << "Downscaling moved before: " + filterChain.mid(target, first - target).join(",");
+    for (int i = first; i <= scaleIndex; i++) filterChain.move(i, target + i - first);
+}
+
+QSize FilterOptimizer::sizeAt(const QStringList &filterChain, int index) const
+{
+    QSize size = _sourceSize;
+    bool sourceCropped = false;
+
+    // These filters don't change the size of the frames
+    QStringList keepSize;
+    keepSize << "lutrgb" << "lut1d" << "lut3d" << "colorspace" << "zscale" << "setpts" << "minterpolate" << "yadif" << "unpremultiply";
+
+    for (int i = 0; i < index && i < filterChain.count() && size.isValid(); i++)
+    {
+        QString filter = filterChain.at(i);
+        QString name;
+        QHash<QString, QString> opts = options(filter, name, QStringList() << "w" << "h");
+
+        // Already taken into account
+        if (filter == _sourceCrop && !sourceCropped)
+        {
+            sourceCropped = true;
+            continue;
+        }
+
+        if (keepSize.contains(name))
+        {
+            // zscale may resize too
+            if (name == "zscale" && (opts.contains("w") || opts.contains("h") || opts.contains("width") || opts.contains("height") || opts.contains("size") || opts.contains("s"))) return QSize();
+            continue;
+        }
+
+        if (name == "scale" || name == "crop")
+        {
+            if (opts.contains("force_original_aspect_ratio")) return QSize();
+            int w = dimension(opts.value("w"), size);
+            int h = dimension(opts.value("h"), size);
+            if (w <= 0 || h <= 0) return QSize();
+            size = QSize(w, h);
+            continue;
+        }
+
+        // Custom or unknown filter
+        return QSize();
+    }
+
+    return size;
+}
+
+int FilterOptimizer::dimension(QString value, QSize size) const
+{
+    if (value == "in_w" || value == "iw") return size.isValid() ? size.width() : -1;
+    if (value == "in_h" || value == "ih") return size.isValid() ? size.height() : -1;
+    bool ok = true;
+    int v = value.toInt(&ok);
+    if (!ok) return -1;
+    return v;
+}
@@ -0,0 +1,81 @@
+#ifndef FILTEROPTIMIZER_H
+#define FILTEROPTIMIZER_H
+
+#include <QStringList>
+#include <QHash>
+#include <QSize>
+#include <QRegularExpression>
+
+/**
+ * @brief The FilterOptimizer class rewrites an ffmpeg video filter chain to make fewer or cheaper passes on the frames.
+ * It removes the conversions which don't change anything, simplifies the resize filters,
+ * and moves downscaling before the per-pixel and temporal filters, so that they process fewer pixels.
+ * The filters it doesn't know are never moved nor crossed.
+ */
+class FilterOptimizer
+{
+public:
+    /**
+     * @brief Constructs an optimizer
+     * @param sourceSize The size of the frames entering the chain (after the crop). Invalid if unknown, some optimizations are then skipped.
+     * @param sourceCrop The crop filter of the chain already taken into account in the source size, if any
+     */
+    FilterOptimizer(QSize sourceSize = QSize(), QString sourceCrop = "");
+
+    /**
+     * @brief Optimizes the filters
+     * @param filterChain The video filters, in order
+     * @return The new filter chain
+     */
+    QStringList optimize(QStringList filterChain);
+    /**
+     * @brief The description of the changes made by the last call to optimize()
+     */
+    QStringList changes() const;
+
+    /**
+     * @brief Reads a filter as generated by FFmpegRenderer::generateFilter(), unescaping the options
+     * @param filter The filter
+     * @param name Set to the name of the filter
+     * @return The options of the filter (key, value) or (value)
+     */
+    static QList<QStringList> parseFilter(QString filter, QString &name);
+
+private:
+    /**
+     * @brief The options of a filter, by name. Positional options get the names in the given order.
+     */
+    static QHash<QString, QString> options(QString filter, QString &name, QStringList positionalNames = QStringList());
+    /**
+     * @brief Checks if a filter does not change the frames at all
+     * @param size The size of the frames entering the filter, invalid if unknown
+     */
+    bool isIdentity(QString filter, QSize size);
+    /**
+     * @brief Crops before scaling instead of scaling then cropping, and removes the padding when it's empty
+     */
+    void fuseResize(QStringList &filterChain);
+    /**
+     * @brief Moves the first scale filter before the per-pixel and temporal filters if it reduces the size of the frames
+     */
+    void moveDownscale(QStringList &filterChain);
+    /**
+     * @brief Gets the size of the frames entering a filter of the chain
+     * @return An invalid size if a filter before it may change the size in a way which is not known (custom filters...)
+     */
+    QSize sizeAt(const QStringList &filterChain, int index) const;
+    /**
+     * @brief Gets a dimension set by a filter option
+     * @param size The size of the frames entering the filter, for in_w and in_h
+     * @return The value in pixels, or -1 if it's an expression
+     */
+    int dimension(QString value, QSize size) const;
+
+    QSize _sourceSize;
+    QString _sourceCrop;
+    QStringList _changes;
+    // The crop filters inserted before a scale, which move with it
+    QStringList _resizeCrops;
+};
+
+#endif // FILTEROPTIMIZER_H
@@ -0,0 +1,87 @@
+#include "framefeeder.h"
+
+// Milliseconds between two checks of the rendered frames
+#define FEED_INTERVAL 100
+// The maximum amount of data waiting to be read by the target, in Bytes
+#define MAX_BUFFER_SIZE 67108864
+
+FrameFeeder::FrameFeeder(AERenderer *source, AbstractRenderer *target, QString dirPath, QString nameFilter, QObject *parent) : QObject(parent)
+{
+    _source = source;
+    _target = target;
+    _dir = QDir(dirPath);
+    _nameFilter = nameFilter;
+    _fedFrames = 0;
+
+    _timer = new QTimer(this);
+    _timer->setInterval(FEED_INTERVAL);
+    connect(_timer, SIGNAL(timeout()), this, SLOT(feed()));
+}
+
+void FrameFeeder::start()
+{
+    _fedFrames = 0;
+    _frames.clear();
+    _timer->start();
+    feed();
+}
+
+void FrameFeeder::stop()
+{
+    if (!_timer->isActive()) return;
+    _timer->stop();
+    _target->closeInput();
+}
+
+int FrameFeeder::numFedFrames() const
+{
+    return _fedFrames;
+}
+
+void FrameFeeder::feed()
+{
+    // Once After Effects has finished, all the frames on disk are complete
+    bool sourceDone = !MediaUtils::isBusy( _source->status() );
+    int available = sourceDone ? -1 : _source->completedFrames();
+
+    // List the folder only when new frames are available
+    if (_fedFrames >= _frames.count() && (sourceDone || available > _fedFrames)) listFrames();
+
+    while (_fedFrames < _frames.count() && (sourceDone || _fedFrames < available))
+    {
+        // Don't fill the memory if the target is slower
+        if (_target->inputBufferSize() > MAX_BUFFER_SIZE) return;
+
+        QFile frame( _dir.absoluteFilePath( _frames.at(_fedFrames) ) );
+        if (!frame.open(QIODevice::ReadOnly))
+        {
+            qWarning().noquote() << "Cannot read the frame " + frame.fileName();
+            break;
+        }
+        if (!_target->writeInput( frame.readAll() ))
+        {
+            // The target has stopped
+            frame.close();
+            stop();
+            emit finished();
+            return;
+        }
+        frame.close();
+        _fedFrames++;
+    }
+
+    if (!sourceDone || _fedFrames < _frames.count()) return;
+    // Frames may have been added since the last listing
+    listFrames();
+    if (_fedFrames >= _frames.count())
+    {
+        stop();
+        emit finished();
+    }
+}
+
+void FrameFeeder::listFrames()
+{
+    // The frame numbers are padded: the name order is the frame order
+    _frames = _dir.entryList(QStringList(_nameFilter), QDir::Files, QDir::Name);
+}
@@ -0,0 +1,69 @@
+#ifndef FRAMEFEEDER_H
+#define FRAMEFEEDER_H
+
+#include <QObject>
+#include <QDir>
+#include <QFile>
+#include <QTimer>
+#include <QStringList>
+#include <QtDebug>
+
+#include "AfterEffects/aerenderer.h"
+
+/**
+ * @brief The FrameFeeder class sends the frames rendered by After Effects to ffmpeg, in order, as soon as they're complete.
+ * This allows ffmpeg to transcode while After Effects is still rendering.
+ */
+class FrameFeeder : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructs a feeder
+     * @param source The After Effects renderer writing the frames
+     * @param target The renderer reading the frames on its standard input
+     * @param dirPath The folder where the frames are rendered
+     * @param nameFilter The file name filter of the frames
+     * @param parent The parent QObject
+     */
+    explicit FrameFeeder(AERenderer *source, AbstractRenderer *target, QString dirPath, QString nameFilter, QObject *parent = nullptr);
+
+    /**
+     * @brief Starts sending the frames
+     */
+    void start();
+    /**
+     * @brief Stops sending frames, and closes the standard input of the target
+     */
+    void stop();
+    /**
+     * @brief The number of frames already sent
+     * @return
+     */
+    int numFedFrames() const;
+
+signals:
+    /**
+     * @brief Emitted when all the frames have been sent
+     */
+    void finished();
+
+private slots:
+    // Sends the frames which are complete
+    void feed();
+
+private:
+    // Lists the frames rendered so far
+    void listFrames();
+
+    AERenderer *_source;
+    AbstractRenderer *_target;
+    QDir _dir;
+    QString _nameFilter;
+    QTimer *_timer;
+    // The frames found in the folder, in order
+    QStringList _frames;
+    int _fedFrames;
+};
+
+#endif // FRAMEFEEDER_H
@@ -0,0 +1,224 @@
+#include "jobserver.h"
+
+// Milliseconds between two progress events
+#define PROGRESS_INTERVAL 1000
+
+JobServer::JobServer(QString name, QObject *parent) : QObject(parent)
+{
+    _name = name;
+    _error = "";
+    _nextId = 1;
+
+    _server = new QLocalServer(this);
+    // Only the current user can submit jobs
+    _server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+
+    _progressTimer = new QTimer(this);
+    _progressTimer->setInterval(PROGRESS_INTERVAL);
+    connect(_progressTimer, SIGNAL(timeout()), this, SLOT(sendProgress()));
+}
+
+bool JobServer::listen()
+{
+    if (_server->listen(_name)) return true;
+
+    // The socket may have been left by a server which has crashed
+    if (_server->serverError() == QAbstractSocket::AddressInUseError)
+    {
+        QLocalSocket test;
+        test.connectToServer(_name);
+        if (!test.waitForConnected(1000))
+        {
+            QLocalServer::removeServer(_name);
+            if (_server->listen(_name)) return true;
+        }
+    }
+
+    _error = "Cannot listen on " + _name + ": " + _server->errorString();
+    return false;
+}
+
+QString JobServer::error() const
+{
+    return _error;
+}
+
+QString JobServer::serverName() const
+{
+    return _server->fullServerName();
+}
+
+void JobServer::newConnection()
+{
+    while (_server->hasPendingConnections())
+    {
+        QLocalSocket *client = _server->nextPendingConnection();
+        connect(client, SIGNAL(readyRead()), this, SLOT(readyRead()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        qDebug() << "New job client connected";
+    }
+}
+
+void JobServer::readyRead()
+{
+    QLocalSocket *client = qobject_cast<QLocalSocket *>( sender() );
+    if (!client) return;
+
+    while (client->canReadLine())
+    {
+        QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (!doc.isObject())
+        {
+            QJsonObject err;
+            err.insert("event", "error");
+            err.insert("error", "Invalid JSON: " + parseError.errorString());
+            send(client, err);
+            continue;
+        }
+
+        command(client, doc.object());
+    }
+}
+
+void JobServer::clientDisconnected()
+{
+    QLocalSocket *client = qobject_cast<QLocalSocket *>( sender() );
+    if (!client) return;
+    // The jobs go on, their events are just not sent anymore
+    client->deleteLater();
+}
+
+void JobServer::itemStatusChanged(MediaUtils::RenderStatus status)
+{
+    QueueItem *item = qobject_cast<QueueItem *>( sender() );
+    if (!item || !_ids.contains(item)) return;
+
+    int id = _ids.value(item);
+    QLocalSocket *client = _clients.value(item);
+
+    QJsonObject message;
+    message.insert("id", id);
+    message.insert("status", MediaUtils::RenderStatusToHumanString(status));
+
+    if (status == MediaUtils::Finished || status == MediaUtils::Stopped || status == MediaUtils::Error)
+    {
+        message.insert("event", "finished");
+        QJsonArray outputs;
+        foreach(MediaInfo *m, item->getOutputMedias()) outputs.append( m->fileName() );
+        message.insert("outputs", outputs);
+        send(client, message);
+
+        qInfo().noquote() << "Job " + QString::number(id) + " (" + _names.value(item) + "): " + MediaUtils::RenderStatusToHumanString(status);
+
+        // Forget the job, the daemon must not grow with the number of jobs
+        _jobs.remove(id);
+        _ids.remove(item);
+        _names.remove(item);
+        _clients.remove(item);
+        item->deleteLater();
+
+        if (_jobs.count() == 0) _progressTimer->stop();
+        return;
+    }
+
+    message.insert("event", "statusChanged");
+    send(client, message);
+}
+
+void JobServer::sendProgress()
+{
+    foreach(QueueItem *item, RenderQueue::instance()->currentItems())
+    {
+        if (!_ids.contains(item)) continue;
+        AbstractRenderer *renderer = RenderQueue::instance()->itemRenderer(item);
+        if (!renderer) continue;
+
+        QJsonObject message;
+        message.insert("event", "progress");
+        message.insert("id", _ids.value(item));
+        message.insert("frame", renderer->currentFrame());
+        message.insert("numFrames", renderer->numFrames());
+        message.insert("outputSize", renderer->outputSize());
+        message.insert("speed", renderer->encodingSpeed());
+        send(_clients.value(item), message);
+    }
+}
+
+void JobServer::command(QLocalSocket *client, QJsonObject cmd)
+{
+    QString c = cmd.value("command").toString();
+
+    if (c == "submit") submit(client, cmd.value("job").toObject());
+    else if (c == "status") sendStatus(client);
+    else
+    {
+        QJsonObject err;
+        err.insert("event", "error");
+        err.insert("error", "Unknown command: " + c);
+        send(client, err);
+    }
+}
+
+void JobServer::submit(QLocalSocket *client, QJsonObject job)
+{
+    QueueItem *item = BatchRunner::createItem(job, this);
+    if (!item)
+    {
+        QJsonObject err;
+        err.insert("event", "error");
+        err.insert("error", "Invalid job, it needs at least one input and one output.");
+        send(client, err);
+        return;
+    }
+
+    int id = _nextId++;
+    QString name = job.value("name").toString( QString::number(id) );
+    _jobs.insert(id, item);
+    _ids.insert(item, id);
+    _names.insert(item, name);
+    _clients.insert(item, client);
+    connect(item, SIGNAL(statusChanged(MediaUtils::RenderStatus)), this, SLOT(itemStatusChanged(MediaUtils::RenderStatus)));
+
+    QJsonObject message;
+    message.insert("event", "submitted");
+    message.insert("id", id);
+    message.insert("name", name);
+    send(client, message);
+
+    RenderQueue::instance()->encode(item);
+    if (!_progressTimer->isActive()) _progressTimer->start();
+}
+
+void JobServer::sendStatus(QLocalSocket *client)
+{
+    QJsonArray jobs;
+    QList<int> ids = _jobs.keys();
+    std::sort(ids.begin(), ids.end());
+    foreach(int id, ids)
+    {
+        QueueItem *item = _jobs.value(id);
+        QJsonObject job;
+        job.insert("id", id);
+        job.insert("name", _names.value(item));
+        job.insert("priority", item->priority());
+        job.insert("status", MediaUtils::RenderStatusToHumanString( item->status() ));
+        jobs.append(job);
+    }
+
+    QJsonObject message;
+    message.insert("event", "status");
+    message.insert("jobs", jobs);
+    send(client, message);
+}
+
+void JobServer::send(QLocalSocket *client, QJsonObject message)
+{
+    if (!client) return;
+    if (client->state() != QLocalSocket::ConnectedState) return;
+    client->write( QJsonDocument(message).toJson(QJsonDocument::Compact) + "\n" );
+}
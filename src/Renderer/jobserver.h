@@ -0,0 +1,96 @@
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <QHash>
+#include <QPointer>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "Renderer/renderqueue.h"
+#include "Renderer/batchrunner.h"
+
+/**
+ * @brief The JobServer class accepts jobs from other processes on a local socket, and renders them with the render queue.
+ * Messages are JSON objects, one per line.
+ * Commands sent by the clients:
+ * { "command": "submit", "job": { a job, as in the BatchRunner job files } }
+ * { "command": "status" }
+ * Events sent by the server, to the client which submitted the job:
+ * { "event": "submitted", "id": 1, "name": "Shot 010" }
+ * { "event": "statusChanged", "id": 1, "status": "Encoding" }
+ * { "event": "progress", "id": 1, "frame": 12, "numFrames": 250, "outputSize": 123456, "speed": 2.5 }
+ * { "event": "finished", "id": 1, "status": "Finished", "outputs": [ "/path/to/shot010.mp4" ] }
+ * { "event": "error", "error": "Invalid job" }
+ */
+class JobServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobServer(QString name = "DuME", QObject *parent = nullptr);
+
+    /**
+     * @brief Starts listening for clients
+     * @return false if the server can't listen, for example if another server is already using the same name
+     */
+    bool listen();
+    /**
+     * @brief The error which prevented the server from listening
+     * @return
+     */
+    QString error() const;
+    /**
+     * @brief The full name of the socket
+     * @return
+     */
+    QString serverName() const;
+
+private slots:
+    void newConnection();
+    void readyRead();
+    void clientDisconnected();
+    void itemStatusChanged(MediaUtils::RenderStatus status);
+    // Sends the progress of the jobs being rendered
+    void sendProgress();
+
+private:
+    /**
+     * @brief Handles a command from a client
+     */
+    void command(QLocalSocket *client, QJsonObject cmd);
+    /**
+     * @brief Creates and queues a job
+     */
+    void submit(QLocalSocket *client, QJsonObject job);
+    /**
+     * @brief Sends the status of all the jobs
+     */
+    void sendStatus(QLocalSocket *client);
+    /**
+     * @brief Sends a message to a client
+     * @param client The client, may be nullptr if it has been disconnected
+     */
+    void send(QLocalSocket *client, QJsonObject message);
+
+    QString _name;
+    QString _error;
+    QLocalServer *_server;
+    // Sends the progress regularly while rendering
+    QTimer *_progressTimer;
+    // The jobs by id
+    QHash<int, QueueItem *> _jobs;
+    QHash<QueueItem *, int> _ids;
+    QHash<QueueItem *, QString> _names;
+    // The client which submitted the job
+    QHash<QueueItem *, QPointer<QLocalSocket>> _clients;
+    int _nextId;
+};
+
+#endif // JOBSERVER_H
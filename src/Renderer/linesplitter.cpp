@@ -0,0 +1,61 @@
+#include "linesplitter.h"
+
+LineSplitter::LineSplitter()
+{
+    _readPos = 0;
+    _scanPos = 0;
+}
+
+void LineSplitter::append(const QByteArray &data)
+{
+    // Everything has been read, start again from the beginning of the buffer
+    if (_readPos == _buffer.size())
+    {
+        _buffer.resize(0);
+        _readPos = 0;
+        _scanPos = 0;
+    }
+    // Discard the data which has been read when it takes most of the buffer
+    else if (_readPos > 4096 && _readPos > _buffer.size() / 2)
+    {
+        _buffer.remove(0, _readPos);
+        _scanPos -= _readPos;
+        _readPos = 0;
+    }
+
+    _buffer.append(data);
+}
+
+bool LineSplitter::readLine(QString &line)
+{
+    const char *data = _buffer.constData();
+    const int size = _buffer.size();
+
+    for (int i = _scanPos; i < size; i++)
+    {
+        // ffmpeg uses \r to update its stats, \n for the logs
+        if (data[i] != '\n' && data[i] != '\r') continue;
+
+        line = QString::fromUtf8(data + _readPos, i - _readPos);
+        _readPos = i + 1;
+        _scanPos = _readPos;
+        return true;
+    }
+
+    _scanPos = size;
+    return false;
+}
+
+QString LineSplitter::takeRemaining()
+{
+    QString line = QString::fromUtf8(_buffer.constData() + _readPos, _buffer.size() - _readPos);
+    clear();
+    return line;
+}
+
+void LineSplitter::clear()
+{
+    _buffer.resize(0);
+    _readPos = 0;
+    _scanPos = 0;
+}
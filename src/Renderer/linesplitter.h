@@ -0,0 +1,44 @@
+#ifndef LINESPLITTER_H
+#define LINESPLITTER_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief The LineSplitter class splits the raw output of a process in lines.
+ * The data is scanned only once: only the new bytes are searched for line endings,
+ * and each line is decoded from UTF-8 only once it is complete.
+ * The consumed data is discarded when it takes most of the buffer, so the buffer keeps its capacity.
+ */
+class LineSplitter
+{
+public:
+    LineSplitter();
+
+    /**
+     * @brief Adds data read from the process
+     * @param data The raw output
+     */
+    void append(const QByteArray &data);
+    /**
+     * @brief Gets the next complete line (without its line ending)
+     * @param line Set to the line, if any
+     * @return false if there's no complete line available
+     */
+    bool readLine(QString &line);
+    /**
+     * @brief Gets the remaining incomplete line, when the process has finished
+     * @return The data not ended by a line ending yet
+     */
+    QString takeRemaining();
+    void clear();
+
+private:
+    QByteArray _buffer;
+    // The start of the data which has not been read yet
+    int _readPos;
+    // Where to resume looking for a line ending
+    int _scanPos;
+};
+
+#endif // LINESPLITTER_H
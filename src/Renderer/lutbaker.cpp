@@ -0,0 +1,412 @@
+#include "lutbaker.h"
+
+// The default number of points per axis of the baked LUTs
+#define DEFAULT_LUT_SIZE 33
+// ffmpeg can't read larger LUTs
+#define MAX_LUT_SIZE 256
+
+LutBaker::LutBaker(QObject *parent) : QObject(parent)
+{
+
+}
+
+LutBaker *LutBaker::instance()
+{
+    if (!_instance) _instance = new LutBaker();
+    return _instance;
+}
+
+QStringList LutBaker::bake(QStringList filterChain)
+{
+    QSettings settings;
+    if (!settings.value("color/bakeLuts", true).toBool()) return filterChain;
+    int size = settings.value("color/bakedLutSize", DEFAULT_LUT_SIZE).toInt();
+    if (size < 2) size = 2;
+    if (size > MAX_LUT_SIZE) size = MAX_LUT_SIZE;
+
+    QStringList filters;
+    QStringList runFilters;
+    QList<Step> run;
+
+    // Add an empty filter to end the last run
+    filterChain << "";
+    foreach(QString filter, filterChain)
+    {
+        Step step;
+        if (filter != "" && parseStep(filter, step))
+        {
+            run << step;
+            runFilters << filter;
+            continue;
+        }
+
+        // The run has ended, bake it if it's worth it
+        bool clamped = false;
+        foreach(Step s, run)
+        {
+            if (s.type != Step::Transfer) clamped = true;
+        }
+
+        QString bakedLut = "";
+        // Transfer functions don't clamp the values, the LUT would
+        if (run.count() > 1 && clamped) bakedLut = bakeSteps(run, size);
+
+        if (bakedLut != "") filters << "lut3d='" + FFmpeg::escapeFilterOption( bakedLut ) + "'";
+        else filters += runFilters;
+
+        run.clear();
+        runFilters.clear();
+        if (filter != "") filters << filter;
+    }
+
+    return filters;
+}
+
+void LutBaker::clear()
+{
+    _bakedLuts.clear();
+    _luts.clear();
+}
+
+bool LutBaker::parseStep(QString filter, Step &step)
+{
+    QString name;
+    QList<QStringList> opts = FilterOptimizer::parseFilter(filter, name);
+    if (opts.count() == 0) return false;
+
+    step.description = filter;
+
+    if (name == "lutrgb")
+    {
+        step.type = Step::Gamma;
+        step.gamma[0] = 1.0;
+        step.gamma[1] = 1.0;
+        step.gamma[2] = 1.0;
+        QRegularExpression reGamma("^gammaval\\(\\s*([\\d.]+)\\s*(?:/\\s*([\\d.]+)\\s*)?\\)$");
+        foreach(QStringList opt, opts)
+        {
+            if (opt.count() != 2) return false;
+            if (opt[0].length() != 1) return false;
+            int channel = QString("rgb").indexOf(opt[0]);
+            if (channel < 0) return false;
+            QRegularExpressionMatch match = reGamma.match(opt[1].trimmed());
+            if (!match.hasMatch()) return false;
+            double gamma = match.captured(1).toDouble();
+            if (match.captured(2) != "")
+            {
+                double div = match.captured(2).toDouble();
+                if (div == 0.0) return false;
+                gamma /= div;
+            }
+            if (gamma <= 0.0) return false;
+            step.gamma[channel] = gamma;
+        }
+        return true;
+    }
+
+    if (name == "lut3d" || name == "lut1d")
+    {
+        if (opts.count() != 1) return false;
+        QStringList opt = opts.at(0);
+        if (opt.count() == 2 && opt[0] != "file") return false;
+
+        LutInfo info = LutCache::instance()->lut( opt.last() );
+        if (!info.isValid()) return false;
+        // Values outside of the domain would be clamped by the baked LUT
+        for (int i = 0; i < 3; i++)
+        {
+            if (info.domainMin.value(i) != 0.0 || info.domainMax.value(i) != 1.0) return false;
+        }
+        if (!loadLut(info)) return false;
+
+        step.type = info.dimension == 1 ? Step::Lut1D : Step::Lut3D;
+        step.lut = info.hash;
+        // The content may change, not the name
+        step.description = name + "=" + info.hash;
+        return true;
+    }
+
+    if (name == "zscale")
+    {
+        step.type = Step::Transfer;
+        step.transferIn = "";
+        step.transferOut = "";
+        foreach(QStringList opt, opts)
+        {
+            if (opt.count() != 2) return false;
+            if (opt[0] == "transferin") step.transferIn = opt[1];
+            else if (opt[0] == "transfer") step.transferOut = opt[1];
+            // Anything else (primaries, matrix, range...) can't be baked
+            else if (opt[0] != "dither") return false;
+        }
+        // Without transferin, zscale uses the frame metadata
+        if (toLinear(step.transferIn, 0.5) < 0.0 || fromLinear(step.transferOut, 0.5) < 0.0) return false;
+        return true;
+    }
+
+    return false;
+}
+
+bool LutBaker::loadLut(LutInfo info)
+{
+    if (_luts.contains(info.hash)) return true;
+    if (info.size < 2) return false;
+
+    QFile lutFile(info.path);
+    if (!lutFile.open(QIODevice::ReadOnly)) return false;
+    QTextStream in(&lutFile);
+
+    QString suffix = QFileInfo(info.path).suffix().toLower();
+    bool is3dl = suffix == "3dl";
+    if (!is3dl && suffix != "cube") return false;
+
+    LutData data;
+    data.dimension = info.dimension;
+    data.size = info.size;
+    int numPoints = info.size;
+    if (info.dimension == 3) numPoints = info.size * info.size * info.size;
+    data.values.resize(numPoints * 3);
+
+    QRegularExpression reSpace("\\s+");
+    int point = 0;
+    QString line = in.readLine();
+    while (!line.isNull() && point < numPoints)
+    {
+        QStringList words = line.trimmed().split(reSpace, QString::SkipEmptyParts);
+        line = in.readLine();
+        // Keywords and the 3dl shaper line are not triplets
+        if (words.count() != 3) continue;
+        bool ok = true;
+        double values[3];
+        for (int i = 0; i < 3 && ok; i++) values[i] = words.at(i).toDouble(&ok);
+        if (!ok) continue;
+
+        int index = point;
+        if (is3dl)
+        {
+            // Blue varies fastest in 3dl files, and the values are on 12 bits (ffmpeg divides by 4096 too)
+            int r = point / (info.size * info.size);
+            int g = (point / info.size) % info.size;
+            int b = point % info.size;
+            index = (b * info.size + g) * info.size + r;
+            for (int i = 0; i < 3; i++) values[i] /= 4096.0;
+        }
+        for (int i = 0; i < 3; i++) data.values[index * 3 + i] = values[i];
+        point++;
+    }
+    lutFile.close();
+
+    if (point != numPoints)
+    {
+        qDebug().noquote() << "Can't read the LUT values of " + info.path;
+        return false;
+    }
+
+    _luts.insert(info.hash, data);
+    return true;
+}
+
+QString LutBaker::bakeSteps(QList<Step> steps, int size)
+{
+    // The hash of the transforms, the size, and the interpolation (LUTs baked with another one are not reused)
+    QString description = "tetrahedral|" + QString::number(size);
+    foreach(Step step, steps) description += "|" + step.description;
+    QString hash = QCryptographicHash::hash(description.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    if (_bakedLuts.contains(hash) && QFileInfo::exists(_bakedLuts.value(hash))) return _bakedLuts.value(hash);
+
+    QString path = bakeDir().absolutePath() + "/" + hash + ".cube";
+    if (!QFileInfo::exists(path))
+    {
+        QDir().mkpath(bakeDir().absolutePath());
+        QSaveFile lutFile(path);
+        if (!lutFile.open(QIODevice::WriteOnly)) return "";
+        QTextStream out(&lutFile);
+        out << "TITLE \"DuME baked color transforms\"\n";
+        out << "LUT_3D_SIZE " << size << "\n";
+        out.setRealNumberNotation(QTextStream::FixedNotation);
+        out.setRealNumberPrecision(6);
+
+        // Red varies fastest
+        for (int b = 0; b < size; b++)
+        {
+            for (int g = 0; g < size; g++)
+            {
+                for (int r = 0; r < size; r++)
+                {
+                    double rgb[3];
+                    rgb[0] = double(r) / (size - 1);
+                    rgb[1] = double(g) / (size - 1);
+                    rgb[2] = double(b) / (size - 1);
+                    foreach(Step step, steps) apply(step, rgb);
+                    out << clamp(rgb[0]) << " " << clamp(rgb[1]) << " " << clamp(rgb[2]) << "\n";
+                }
+            }
+        }
+
+        out.flush();
+        if (!lutFile.commit()) return "";
+        qDebug().noquote() << "Color transforms baked: " + path + "\n" + description;
+    }
+
+    _bakedLuts.insert(hash, path);
+    return path;
+}
+
+void LutBaker::apply(const Step &step, double rgb[])
+{
+    if (step.type == Step::Gamma)
+    {
+        // lutrgb works on clamped integer values
+        for (int i = 0; i < 3; i++) rgb[i] = std::pow( clamp(rgb[i]), step.gamma[i] );
+    }
+    else if (step.type == Step::Transfer)
+    {
+        for (int i = 0; i < 3; i++) rgb[i] = fromLinear( step.transferOut, toLinear( step.transferIn, rgb[i] ) );
+    }
+    else if (step.type == Step::Lut1D)
+    {
+        const LutData &data = _luts[step.lut];
+        for (int i = 0; i < 3; i++)
+        {
+            double x = clamp(rgb[i]) * (data.size - 1);
+            int prev = int(x);
+            int next = prev + 1 < data.size ? prev + 1 : prev;
+            double f = x - prev;
+            rgb[i] = data.values.at(prev * 3 + i) * (1.0 - f) + data.values.at(next * 3 + i) * f;
+        }
+    }
+    else if (step.type == Step::Lut3D)
+    {
+        // Tetrahedral interpolation, the default of the ffmpeg lut3d filter
+        const LutData &data = _luts[step.lut];
+        int s = data.size;
+        int prev[3];
+        int next[3];
+        double f[3];
+        for (int i = 0; i < 3; i++)
+        {
+            double x = clamp(rgb[i]) * (s - 1);
+            prev[i] = int(x);
+            next[i] = prev[i] + 1 < s ? prev[i] + 1 : prev[i];
+            f[i] = x - prev[i];
+        }
+        double fr = f[0];
+        double fg = f[1];
+        double fb = f[2];
+
+        // The two corners between the first and the last one, and the weights of the four corners
+        int c1[3];
+        int c2[3];
+        double w[4];
+        if (fr > fg)
+        {
+            if (fg > fb)
+            {
+                c1[0] = next[0]; c1[1] = prev[1]; c1[2] = prev[2];
+                c2[0] = next[0]; c2[1] = next[1]; c2[2] = prev[2];
+                w[0] = 1.0 - fr; w[1] = fr - fg; w[2] = fg - fb; w[3] = fb;
+            }
+            else if (fr > fb)
+            {
+                c1[0] = next[0]; c1[1] = prev[1]; c1[2] = prev[2];
+                c2[0] = next[0]; c2[1] = prev[1]; c2[2] = next[2];
+                w[0] = 1.0 - fr; w[1] = fr - fb; w[2] = fb - fg; w[3] = fg;
+            }
+            else
+            {
+                c1[0] = prev[0]; c1[1] = prev[1]; c1[2] = next[2];
+                c2[0] = next[0]; c2[1] = prev[1]; c2[2] = next[2];
+                w[0] = 1.0 - fb; w[1] = fb - fr; w[2] = fr - fg; w[3] = fg;
+            }
+        }
+        else
+        {
+            if (fb > fg)
+            {
+                c1[0] = prev[0]; c1[1] = prev[1]; c1[2] = next[2];
+                c2[0] = prev[0]; c2[1] = next[1]; c2[2] = next[2];
+                w[0] = 1.0 - fb; w[1] = fb - fg; w[2] = fg - fr; w[3] = fr;
+            }
+            else if (fb > fr)
+            {
+                c1[0] = prev[0]; c1[1] = next[1]; c1[2] = prev[2];
+                c2[0] = prev[0]; c2[1] = next[1]; c2[2] = next[2];
+                w[0] = 1.0 - fg; w[1] = fg - fb; w[2] = fb - fr; w[3] = fr;
+            }
+            else
+            {
+                c1[0] = prev[0]; c1[1] = next[1]; c1[2] = prev[2];
+                c2[0] = next[0]; c2[1] = next[1]; c2[2] = prev[2];
+                w[0] = 1.0 - fg; w[1] = fg - fr; w[2] = fr - fb; w[3] = fb;
+            }
+        }
+
+        int index[4];
+        index[0] = ((prev[2] * s + prev[1]) * s + prev[0]) * 3;
+        index[1] = ((c1[2] * s + c1[1]) * s + c1[0]) * 3;
+        index[2] = ((c2[2] * s + c2[1]) * s + c2[0]) * 3;
+        index[3] = ((next[2] * s + next[1]) * s + next[0]) * 3;
+        double result[3] = { 0.0, 0.0, 0.0 };
+        for (int corner = 0; corner < 4; corner++)
+        {
+            for (int i = 0; i < 3; i++) result[i] += data.values.at(index[corner] + i) * w[corner];
+        }
+        for (int i = 0; i < 3; i++) rgb[i] = result[i];
+    }
+}
+
+double LutBaker::toLinear(QString transfer, double v)
+{
+    if (transfer == "linear") return v;
+    // Out of range values (from lut3d, colorspace...) keep their sign
+    if (v < 0.0) return -toLinear(transfer, -v);
+    // BT.709 and the like
+    if (transfer == "709" || transfer == "601" || transfer == "2020_10" || transfer == "2020_12")
+    {
+        if (v < 0.081) return v / 4.5;
+        return std::pow( (v + 0.099) / 1.099, 1 / 0.45 );
+    }
+    // sRGB
+    if (transfer == "iec61966-2-1")
+    {
+        if (v <= 0.04045) return v / 12.92;
+        return std::pow( (v + 0.055) / 1.055, 2.4 );
+    }
+    // Unknown
+    return -1.0;
+}
+
+double LutBaker::fromLinear(QString transfer, double v)
+{
+    if (transfer == "linear") return v;
+    // Don't raise negative values to a power
+    if (v < 0.0) return -fromLinear(transfer, -v);
+    if (transfer == "709" || transfer == "601" || transfer == "2020_10" || transfer == "2020_12")
+    {
+        if (v < 0.018) return v * 4.5;
+        return 1.099 * std::pow( v, 0.45 ) - 0.099;
+    }
+    if (transfer == "iec61966-2-1")
+    {
+        if (v <= 0.0031308) return v * 12.92;
+        return 1.055 * std::pow( v, 1 / 2.4 ) - 0.055;
+    }
+    return -1.0;
+}
+
+double LutBaker::clamp(double v)
+{
+    if (v < 0.0) return 0.0;
+    if (v > 1.0) return 1.0;
+    return v;
+}
+
+QDir LutBaker::bakeDir() const
+{
+    QString lutPath = LutCache::instance()->cacheDir().path();
+    if (lutPath == "" || lutPath == ".") return QDir(QDir::tempPath() + "/DuME/bakedLuts");
+    return QDir(lutPath + "/baked");
+}
+
+LutBaker *LutBaker::_instance = nullptr;
@@ -0,0 +1,114 @@
+#ifndef LUTBAKER_H
+#define LUTBAKER_H
+
+#include <QObject>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSettings>
+#include <QCryptographicHash>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QHash>
+#include <QVector>
+#include <QtDebug>
+
+#include <cmath>
+
+#include "Renderer/lutcache.h"
+#include "Renderer/filteroptimizer.h"
+#include "FFmpeg/ffmpeg.h"
+
+/**
+ * @brief The LutBaker class compiles the color filters of a filter chain into 3D LUTs.
+ * The consecutive color transforms which can be evaluated offline (gamma lutrgb, 1D and 3D LUTs, zscale transfer conversions)
+ * are computed on a grid and replaced by a single lut3d filter, so that ffmpeg makes only one pass on the frames.
+ * The baked LUTs are cached, named with the hash of the transforms they replace.
+ */
+class LutBaker : public QObject
+{
+    Q_OBJECT
+public:
+    static LutBaker *instance();
+
+    /**
+     * @brief Replaces the runs of color filters which can be evaluated offline with baked 3D LUTs.
+     * A run is baked only if it contains at least two filters, one of them clamping the values (a LUT),
+     * so that the result is the same as the original chain. Other filters are kept as they are.
+     * Does nothing if the "color/bakeLuts" setting is false.
+     * @param filterChain The video filters, in order
+     * @return The new filter chain
+     */
+    QStringList bake(QStringList filterChain);
+
+public slots:
+    /**
+     * @brief Forgets the baked LUTs and the LUT data read so far
+     */
+    void clear();
+
+private:
+    //private constructor, this is a singleton
+    explicit LutBaker(QObject *parent = nullptr);
+
+    /**
+     * @brief A color transform which can be evaluated offline
+     */
+    class Step
+    {
+    public:
+        enum Type { Gamma, Lut1D, Lut3D, Transfer };
+        Type type;
+        // The gamma for each channel
+        double gamma[3];
+        // The LUT content hash, to get its data
+        QString lut;
+        // The transfer functions (zscale names)
+        QString transferIn;
+        QString transferOut;
+        // The description used to hash the chain
+        QString description;
+    };
+
+    /**
+     * @brief The values of a LUT, normalized. The red channel varies fastest for 3D LUTs.
+     */
+    class LutData
+    {
+    public:
+        int dimension;
+        int size;
+        QVector<double> values;
+    };
+
+    /**
+     * @brief Checks if a filter can be evaluated offline
+     * @return false if the filter has to be kept as it is
+     */
+    bool parseStep(QString filter, Step &step);
+    /**
+     * @brief Reads the values of a LUT
+     * @return false if the format is not supported
+     */
+    bool loadLut(LutInfo info);
+    /**
+     * @brief Evaluates the transforms on a grid and writes the baked LUT, if it's not already cached
+     * @return The path of the baked LUT, or an empty string on failure
+     */
+    QString bakeSteps(QList<Step> steps, int size);
+    void apply(const Step &step, double rgb[3]);
+    static double toLinear(QString transfer, double v);
+    static double fromLinear(QString transfer, double v);
+    static double clamp(double v);
+    QDir bakeDir() const;
+
+    // The baked LUTs, by hash of the transforms
+    QHash<QString, QString> _bakedLuts;
+    // The LUT data, by hash of the LUT content
+    QHash<QString, LutData> _luts;
+
+protected:
+    static LutBaker *_instance;
+};
+
+#endif // LUTBAKER_H
@@ -0,0 +1,153 @@
+#include "lutcache.h"
+
+LutInfo::LutInfo()
+{
+    path = "";
+    hash = "";
+    dimension = 3;
+    size = 0;
+    domainMin << 0.0 << 0.0 << 0.0;
+    domainMax << 1.0 << 1.0 << 1.0;
+}
+
+bool LutInfo::isValid() const
+{
+    return path != "";
+}
+
+LutCache::LutCache(QObject *parent) : QObject(parent)
+{
+    _cachePath = "";
+}
+
+LutCache *LutCache::instance()
+{
+    if (!_instance) _instance = new LutCache();
+    return _instance;
+}
+
+LutInfo LutCache::lut(QString name)
+{
+    if (name == "") return LutInfo();
+
+    bool isResource = name.startsWith(":/");
+
+    // Files may have changed since they were read
+    QString stamp = "";
+    if (!isResource)
+    {
+        QFileInfo lutFile(name);
+        stamp = QString::number( lutFile.size() ) + "|" + QString::number( lutFile.lastModified().toMSecsSinceEpoch() );
+        if (_fileStamps.value(name) != stamp) _luts.remove(name);
+    }
+    // The extracted file may have been removed from the cache folder (purged, evicted...)
+    else if (_luts.contains(name) && !QFileInfo::exists(_luts.value(name).path)) _luts.remove(name);
+
+    if (_luts.contains(name)) return _luts.value(name);
+
+    LutInfo info;
+    QFile lutFile(name);
+    if (!lutFile.open(QIODevice::ReadOnly)) return info;
+    QByteArray content = lutFile.readAll();
+    lutFile.close();
+
+    QString suffix = QFileInfo(name).suffix().toLower();
+    info.hash = QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex();
+    parse(content, suffix, info);
+
+    if (isResource)
+    {
+        // ffmpeg can't read resources, extract it (once, the name is the hash of the content)
+        info.path = _cachePath + "/" + info.hash + "." + suffix;
+        if (!QFileInfo::exists(info.path))
+        {
+            QDir().mkpath(_cachePath);
+            QSaveFile extracted(info.path);
+            if (!extracted.open(QIODevice::WriteOnly)) return LutInfo();
+            extracted.write(content);
+            if (!extracted.commit()) return LutInfo();
+            qDebug().noquote() << "LUT extracted: " + info.path;
+        }
+    }
+    else
+    {
+        info.path = name;
+        _fileStamps.insert(name, stamp);
+    }
+
+    _luts.insert(name, info);
+    return info;
+}
+
+void LutCache::setCacheDir(QString path)
+{
+    _cachePath = path;
+    clear();
+}
+
+QDir LutCache::cacheDir() const
+{
+    return QDir(_cachePath);
+}
+
+void LutCache::clear()
+{
+    _luts.clear();
+    _fileStamps.clear();
+}
+
+void LutCache::parse(const QByteArray &content, QString suffix, LutInfo &info)
+{
+    QTextStream in(content);
+
+    if (suffix == "cube")
+    {
+        QString line = in.readLine();
+        while (!line.isNull())
+        {
+            QStringList words = line.trimmed().split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+            line = in.readLine();
+            if (words.count() < 2) continue;
+            QString keyword = words.at(0).toUpper();
+
+            if (keyword == "LUT_1D_SIZE")
+            {
+                info.dimension = 1;
+                info.size = words.at(1).toInt();
+            }
+            else if (keyword == "LUT_3D_SIZE")
+            {
+                info.dimension = 3;
+                info.size = words.at(1).toInt();
+            }
+            else if ((keyword == "DOMAIN_MIN" || keyword == "DOMAIN_MAX") && words.count() >= 4)
+            {
+                QList<double> domain;
+                for (int i = 1; i < 4; i++) domain << words.at(i).toDouble();
+                if (keyword == "DOMAIN_MIN") info.domainMin = domain;
+                else info.domainMax = domain;
+            }
+            // The data starts, the keywords are before
+            else if (words.at(0).at(0).isDigit() || words.at(0).startsWith("-") || words.at(0).startsWith(".")) break;
+        }
+    }
+    else if (suffix == "3dl")
+    {
+        // The first line of values is the shaper, the other ones are the data (size^3 lines)
+        int numLines = 0;
+        QString line = in.readLine();
+        while (!line.isNull())
+        {
+            QStringList words = line.trimmed().split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+            line = in.readLine();
+            if (words.count() == 0) continue;
+            if (!words.at(0).at(0).isDigit()) continue;
+            numLines++;
+        }
+        info.dimension = 3;
+        int size = int( std::round( std::cbrt( numLines - 1 ) ) );
+        if (size > 0 && size * size * size == numLines - 1) info.size = size;
+    }
+}
+
+LutCache *LutCache::_instance = nullptr;
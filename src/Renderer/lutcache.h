@@ -0,0 +1,99 @@
+#ifndef LUTCACHE_H
+#define LUTCACHE_H
+
+#include <QObject>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QHash>
+#include <QtDebug>
+
+#include <cmath>
+
+/**
+ * @brief The LutInfo class describes a LUT file
+ */
+class LutInfo
+{
+public:
+    LutInfo();
+
+    /**
+     * @brief The path of the file to use in ffmpeg commands
+     */
+    QString path;
+    /**
+     * @brief The SHA1 of the content
+     */
+    QString hash;
+    /**
+     * @brief 1 for 1D LUTs, 3 for 3D LUTs
+     */
+    int dimension;
+    /**
+     * @brief The number of points of the LUT (per axis), 0 if unknown
+     */
+    int size;
+    /**
+     * @brief The input domain of the LUT
+     */
+    QList<double> domainMin;
+    QList<double> domainMax;
+
+    bool isValid() const;
+};
+
+/**
+ * @brief The LutCache class extracts the LUTs once per session, in a folder where they're named with the hash of their content,
+ * and keeps their description so that filters can be generated without reading the files again.
+ */
+class LutCache : public QObject
+{
+    Q_OBJECT
+public:
+    static LutCache *instance();
+
+    /**
+     * @brief Gets a LUT, extracting it if it's a resource
+     * @param name The path of the LUT (a file or a Qt resource)
+     * @return The description of the LUT
+     */
+    LutInfo lut(QString name);
+    /**
+     * @brief Sets the folder where the resource LUTs are extracted
+     * @param path The folder
+     */
+    void setCacheDir(QString path);
+    QDir cacheDir() const;
+
+public slots:
+    /**
+     * @brief Forgets all LUTs. They will be extracted and read again when needed.
+     */
+    void clear();
+
+private:
+    //private constructor, this is a singleton
+    explicit LutCache(QObject *parent = nullptr);
+
+    /**
+     * @brief Reads the description of the LUT from its content
+     */
+    static void parse(const QByteArray &content, QString suffix, LutInfo &info);
+
+    QString _cachePath;
+    // The LUTs, by name
+    QHash<QString, LutInfo> _luts;
+    // For LUTs which are not resources, the size and date of the file when it was read
+    QHash<QString, QString> _fileStamps;
+
+protected:
+    static LutCache *_instance;
+};
+
+#endif // LUTCACHE_H
@@ -3,6 +3,8 @@
 MediaInfo::MediaInfo( QObject *parent ) : QObject(parent)
 {
     _id = -1;
+    _probeJob = nullptr;
+    _probeSilent = false;
     _outputMedia = false;
     reInit();
 }
@@ -10,6 +12,8 @@ MediaInfo::MediaInfo( QObject *parent ) : QObject(parent)
 MediaInfo::MediaInfo(QFileInfo mediaFile, QObject *parent ) : QObject(parent)
 {
     _id = -1;
+    _probeJob = nullptr;
+    _probeSilent = false;
     _outputMedia = false;
     if ( mediaFile.suffix() == "dffp" ) loadPreset( mediaFile );
     else update( mediaFile );
@@ -17,6 +21,10 @@ MediaInfo::MediaInfo(QFileInfo mediaFile, QObject *parent ) : QObject(parent)
 
 void MediaInfo::reInit(bool removeFileName, bool silent)
 {
+    // Forget any analysis still running for a previous file
+    if (_probeJob) disconnect( _probeJob, nullptr, this, nullptr );
+    _probeJob = nullptr;
+
     // GENERAL
     if (removeFileName) _fileName = "";
     _extensions.clear();
@@ -36,8 +44,10 @@ void MediaInfo::reInit(bool removeFileName, bool silent)
     _videoStreams.clear();
     qDeleteAll(_audioStreams);
     _audioStreams.clear();
+    _numSubtitleStreams = 0;
     // MAPS
     _maps.clear();
+    _mirrors.clear();
     // GENERAL Encoding/decoding parameters
     _cacheDir = nullptr;
     // FFMPEG Encoding/decoding
@@ -48,6 +58,7 @@ void MediaInfo::reInit(bool removeFileName, bool silent)
     _aepCompName = "";
     _aepNumThreads = 1;
     _aepRqindex = -1;
+    _aepStartFrame = -1;
     _aeUseRQueue = false;
 
     if(!silent) emit changed();
@@ -55,6 +66,37 @@ void MediaInfo::reInit(bool removeFileName, bool silent)
 }
 
 void MediaInfo::update(QFileInfo mediaFile, bool silent)
+{
+    if (!prepareUpdate(mediaFile, silent)) return;
+
+    QString ffmpegOutput = FFmpeg::instance()->analyseMedia( mediaFile.absoluteFilePath() );
+
+    parseProbe(ffmpegOutput, silent);
+}
+
+void MediaInfo::updateAsync(QFileInfo mediaFile, bool silent)
+{
+    if (!prepareUpdate(mediaFile, silent)) return;
+
+    _probeSilent = silent;
+    _probeJob = ProbeService::instance()->probe( mediaFile.absoluteFilePath() );
+    connect( _probeJob, &ProbeJob::finished, this, &MediaInfo::probeFinished );
+}
+
+bool MediaInfo::isProbing() const
+{
+    return _probeJob != nullptr;
+}
+
+void MediaInfo::probeFinished(QString output)
+{
+    if (sender() != _probeJob) return;
+    _probeJob = nullptr;
+
+    parseProbe(output, _probeSilent);
+}
+
+bool MediaInfo::prepareUpdate(QFileInfo mediaFile, bool silent)
 {
     reInit();
 
@@ -74,11 +116,121 @@ void MediaInfo::update(QFileInfo mediaFile, bool silent)
     if (!mediaFile.exists())
     {
         if (!silent) emit changed();
-        return;
+        return false;
     }
 
-    QString ffmpegOutput = FFmpeg::instance()->analyseMedia( mediaFile.absoluteFilePath() );
+    return true;
+}
+
+void MediaInfo::parseProbe(QString probe, bool silent)
+{
+    // ffprobe gives a JSON document, ffmpeg its logs
+    QJsonParseError error;
+    QJsonDocument probeDoc = QJsonDocument::fromJson( probe.toUtf8(), &error );
+    if (error.error == QJsonParseError::NoError && probeDoc.isObject()) parseFFprobe( probeDoc.object(), silent );
+    else parseFFmpegProbe( probe, silent );
+
+    if (_muxer->isSequence())
+    {
+        loadSequence();
+    }
+
+    if(!silent) emit changed();
+}
+
+void MediaInfo::parseFFprobe(QJsonObject probe, bool silent)
+{
+    QJsonObject format = probe.value("format").toObject();
+    if (format.isEmpty()) return;
+
+    // Note: ffprobe gives most numbers as strings
+    _extensions = format.value("format_name").toString().split(",");
+    _fileName = QDir::toNativeSeparators( format.value("filename").toString( _fileName ) );
+    _duration = format.value("duration").toString().toDouble();
+    _bitrate = format.value("bit_rate").toString().toLongLong();
+
+    foreach(QJsonValue streamValue, probe.value("streams").toArray())
+    {
+        QJsonObject s = streamValue.toObject();
+        QJsonObject tags = s.value("tags").toObject();
+        QString type = s.value("codec_type").toString();
+
+        if (type == "video")
+        {
+            VideoInfo *stream = new VideoInfo();
+            stream->setId( s.value("index").toInt() );
+            stream->setLanguage( tags.value("language").toString() );
+
+            QString codec = s.value("codec_name").toString();
+            FFCodec *c = FFmpeg::instance()->videoEncoder( codec );
+            if (c->name() == "" ) c = FFmpeg::instance()->videoDecoder( codec );
+            if (c->name() == "" ) c = _muxer->defaultVideoCodec();
+            stream->setCodec( c );
+
+            stream->setPixFormat( FFmpeg::instance()->pixFormat( s.value("pix_fmt").toString() ) );
+
+            stream->setWidth( s.value("width").toInt() );
+            stream->setHeight( s.value("height").toInt() );
+
+            QStringList aspect = s.value("sample_aspect_ratio").toString().split(":");
+            if (aspect.count() == 2 && aspect[0].toInt() > 0 && aspect[1].toInt() > 0)
+            {
+                stream->setPixAspect( aspect[0].toFloat() / aspect[1].toFloat() );
+            }
+
+            stream->setBitrate( s.value("bit_rate").toString().toLongLong() );
+
+            // Exact, rational framerate
+            double fps = MediaUtils::rationalToDouble( s.value("avg_frame_rate").toString() );
+            if (fps == 0.0) fps = MediaUtils::rationalToDouble( s.value("r_frame_rate").toString() );
+            stream->setFramerate( fps );
+
+            stream->setNumFrames( s.value("nb_frames").toString().toInt() );
+
+            // Rotation: display matrix in recent versions of ffmpeg, rotate tag before
+            int rotation = tags.value("rotate").toString().toInt();
+            foreach(QJsonValue sideData, s.value("side_data_list").toArray())
+            {
+                QJsonObject sideDataObj = sideData.toObject();
+                if (sideDataObj.contains("rotation")) rotation = sideDataObj.value("rotation").toInt();
+            }
+            stream->setRotation( rotation, true );
+
+            addVideoStream( stream, silent );
+        }
+        else if (type == "audio")
+        {
+            AudioInfo *stream = new AudioInfo();
+            stream->setId( s.value("index").toInt() );
+            stream->setLanguage( tags.value("language").toString() );
+
+            QString codec = s.value("codec_name").toString();
+            FFCodec *c = FFmpeg::instance()->audioEncoder( codec );
+            if (c->name() == "" ) c = FFmpeg::instance()->audioDecoder( codec );
+            if (c->name() == "" ) c = _muxer->defaultAudioCodec();
+            stream->setCodec(c);
+
+            stream->setSamplingRate( s.value("sample_rate").toString().toInt() );
+
+            QString channels = s.value("channel_layout").toString();
+            if (channels == "") channels = QString::number( s.value("channels").toInt() ) + " channels";
+            stream->setChannels( channels );
+
+            stream->setSampleFormat( s.value("sample_fmt").toString() );
 
+            stream->setBitrate( s.value("bit_rate").toString().toLongLong() );
+
+            addAudioStream( stream );
+        }
+        else if (type == "subtitle")
+        {
+            _numSubtitleStreams++;
+        }
+    }
+}
+
+void MediaInfo::parseFFmpegProbe(QString ffmpegOutput, bool silent)
+{
     QStringList infos = ffmpegOutput.split("\n");
 
     //regexes to get infos
@@ -90,8 +242,12 @@ void MediaInfo::update(QFileInfo mediaFile, bool silent)
     QRegularExpression reFPS = RegExUtils::getRegEx("ffmpeg fps");
     QRegularExpression reBitrate = RegExUtils::getRegEx("ffmpeg bitrate");
     QRegularExpression reAspect = RegExUtils::getRegEx("ffmpeg aspect");
+    // The metadata of the video streams, on the lines following the stream
+    QRegularExpression reRotate("^\\s*rotate\\s*:\\s*(-?\\d+)");
+    QRegularExpression reDisplayMatrix("displaymatrix: rotation of (-?[\\d.]+) degrees");
 
     bool input = false;
+    VideoInfo *lastVideoStream = nullptr;
     foreach(QString info,infos)
     {
         //test input
@@ -164,9 +320,19 @@ void MediaInfo::update(QFileInfo mediaFile, bool silent)
             }
 
             addVideoStream( stream, silent );
+            lastVideoStream = stream;
             continue;
         }
 
+        //test rotation
+        if (lastVideoStream != nullptr)
+        {
+            match = reRotate.match(info);
+            if (match.hasMatch()) lastVideoStream->setRotation( match.captured(1).toInt(), true );
+            match = reDisplayMatrix.match(info);
+            if (match.hasMatch()) lastVideoStream->setRotation( qRound( match.captured(1).toDouble() ), true );
+        }
+
         //test audio stream
         match = reAudioStream.match(info);
         if (match.hasMatch())
@@ -195,15 +361,17 @@ void MediaInfo::update(QFileInfo mediaFile, bool silent)
             }
 
             addAudioStream( stream );
+            lastVideoStream = nullptr;
+            continue;
         }
-    }
 
-    if (_muxer->isSequence())
-    {
-        loadSequence();
+        //test subtitle stream
+        if (info.trimmed().startsWith("Stream #"))
+        {
+            lastVideoStream = nullptr;
+            if (info.contains(": Subtitle:")) _numSubtitleStreams++;
+        }
     }
-
-    if(!silent) emit changed();
 }
 
 void MediaInfo::copyFrom(MediaInfo *other, bool updateFilename, bool silent)
@@ -236,8 +404,10 @@ void MediaInfo::copyFrom(MediaInfo *other, bool updateFilename, bool silent)
         st->copyFrom(stream, true);
         _audioStreams << st;
     }
+    _numSubtitleStreams = other->numSubtitleStreams();
     // MAPS
     _maps = other->maps();
+    _mirrors = other->mirrors();
     // GENERAL Encoding/decoding parameters
     _cacheDir = other->cacheDir();
     // FFMPEG Encoding/decoding
@@ -248,6 +418,7 @@ void MediaInfo::copyFrom(MediaInfo *other, bool updateFilename, bool silent)
     _aepCompName = other->aepCompName();
     _aepNumThreads = other->aepNumThreads();
     _aepRqindex = other->aepRqindex();
+    _aepStartFrame = other->aepStartFrame();
     _aeUseRQueue = other->aeUseRQueue();
 
     if(!silent) emit changed();
@@ -421,7 +592,13 @@ void MediaInfo::loadPreset(QFileInfo presetFile, bool silent)
 
     qDebug() << "Valid JSON";
 
-    QJsonObject mainObj = jsonDoc.object();
+    loadPreset(jsonDoc.object(), silent);
+
+    qDebug() << presetFile.completeBaseName() + " Loaded.";
+}
+
+void MediaInfo::loadPreset(QJsonObject mainObj, bool silent)
+{
     if (mainObj.value("dume").isUndefined()) return;
 
     reInit(false, true);
@@ -485,8 +662,6 @@ void MediaInfo::loadPreset(QFileInfo presetFile, bool silent)
     qDebug() << "OK!";
 
     if(!silent) emit changed();
-
-    qDebug() << presetFile.completeBaseName() + " Loaded.";
 }
 
 QString MediaInfo::exportPreset()
@@ -696,6 +871,33 @@ void MediaInfo::removeAllMaps(bool silent)
     if (!silent) emit changed();
 }
 
+QStringList MediaInfo::mirrors() const
+{
+    return _mirrors;
+}
+
+void MediaInfo::setMirrors(const QStringList &mirrors, bool silent)
+{
+    _mirrors = mirrors;
+    if (!silent) emit changed();
+}
+
+void MediaInfo::addMirror(QString path, bool silent)
+{
+    if (path == "" || _mirrors.contains(path)) return;
+    _mirrors << path;
+    if (!silent) emit changed();
+}
+
+void MediaInfo::removeMirror(int index, bool silent)
+{
+    if (index >= 0 && index < _mirrors.count())
+    {
+        _mirrors.removeAt(index);
+        if (!silent) emit changed();
+    }
+}
+
 void MediaInfo::setMap(int mapIndex, int mediaId, int streamId, bool silent)
 {
     if (mapIndex >= 0 && mapIndex < _maps.count())
@@ -1364,6 +1566,12 @@ void MediaInfo::setAepRqindex(int aepRqindex, bool silent )
     if(!silent) emit changed();
 }
 
+void MediaInfo::setAepStartFrame(int aepStartFrame, bool silent )
+{
+    _aepStartFrame = aepStartFrame;
+    if(!silent) emit changed();
+}
+
 void MediaInfo::setAepNumThreads(int aepNumThreads, bool silent )
 {
     _aepNumThreads = aepNumThreads;
@@ -1486,6 +1694,11 @@ QList<AudioInfo *> MediaInfo::audioStreams() const
     return _audioStreams;
 }
 
+int MediaInfo::numSubtitleStreams() const
+{
+    return _numSubtitleStreams;
+}
+
 bool MediaInfo::hasAlpha()
 {
     if (isAep()) return true;
@@ -1594,6 +1807,11 @@ int MediaInfo::aepRqindex() const
     return _aepRqindex;
 }
 
+int MediaInfo::aepStartFrame() const
+{
+    return _aepStartFrame;
+}
+
 int MediaInfo::aepNumThreads() const
 {
     return _aepNumThreads;
@@ -1644,114 +1862,34 @@ void MediaInfo::loadSequence(bool silent)
         _frames.clear();
         _videoStreams[0]->setStartNumber(0);
 
-        QRegularExpression reDigits("(\\d+)");
-        QRegularExpressionMatchIterator reDigitsMatch = reDigits.globalMatch(baseName);
-
-        //get all files of same type in folder
-        QDir containingDir(dirPath);
-        QFileInfoList files = containingDir.entryInfoList(QStringList("*." + extension),QDir::Files);
-
-        //check for each block of digits if we find a sequence
-        QString error = "";
-        QStringList missingFrames;
-        QStringList emptyFrames;
-        bool incorrect = false;
-
         qDebug() << "Scanning file name.";
 
-        while(reDigitsMatch.hasNext())
-        {
-            incorrect = false;
-
-            QStringList tempFrames;
-            QRegularExpressionMatch match = reDigitsMatch.next();
-            QString digits = match.captured(0);
-
-            //Get frames and check if this is a sequence
-            //list all files in the sequence matching the pattern, and compute size
-            QString left = baseName.left(match.capturedStart(0));
-            QString right = baseName.right(baseName.count() - match.capturedEnd(0));
-            QString pattern = left + "(\\d+)" + right;
-            QRegularExpression re(pattern);
-            _videoStreams[0]->setStartNumber( 999999999 );
-            _endNumber = 0;
-            _emptyFrames.clear();
-            _missingFrames.clear();
-            _size = 0;
-            int numDigits = 0;
-            foreach(QFileInfo f,files)
-            {
-                QRegularExpressionMatch reMatch = re.match(f.completeBaseName());
-                if (reMatch.hasMatch())
-                {
-                    //check num digits
-                    int testNumDigits = reMatch.captured(1).count();
-                    if (numDigits != 0 && numDigits != testNumDigits)
-                    {
-                        incorrect = true;
-                        qDebug() << "Wrong naming, missing leading zeroes";
-                        if (error == "") error = "Incorrect sequence file names.\nNumbers must have leading zeroes (\"8, 9, 10, 11\" has to be \"08, 09, 10, 11\").\n";
-                    }
-                    numDigits = testNumDigits;
-                    //get start frame
-                    int currentNumber = reMatch.captured(1).toInt();
-                    if (currentNumber < _videoStreams[0]->startNumber()) _videoStreams[0]->setStartNumber( currentNumber );
-                    if (currentNumber > _endNumber) _endNumber = currentNumber;
-                    tempFrames << f.filePath();
-                    _size += f.size();
-                    if (f.size() < 10) _emptyFrames << f.filePath();
-                }
-            }
+        //check for each block of digits if we find a sequence
+        FrameSequence sequence = SequenceScanner::instance()->scan( baseFileInfo );
 
-            //Check if numbering is ok
-            int numFrames = _endNumber - _videoStreams[0]->startNumber() + 1;
-            if (_endNumber == _videoStreams[0]->startNumber())
-            {
-                qDebug() << "Wrong digits block.";
-                error = "This does not look like a sequence, we did not find the frame number.";
-                incorrect = true;
-            }
+        _videoStreams[0]->setStartNumber( sequence.startNumber );
+        _endNumber = sequence.endNumber;
+        _missingFrames = sequence.missingFrames;
+        _emptyFrames = sequence.emptyFrames;
+        _size = sequence.size;
 
-            if (numFrames != tempFrames.count() && !incorrect)
-            {
-                incorrect = true;
-                error = "Some frames are missing.\n";
-                tempFrames.sort();
-                int num = _videoStreams[0]->startNumber() - 1;
-                //look for missing frames
-                foreach(QFileInfo f, tempFrames)
-                {
-                    QRegularExpressionMatch test = reDigits.match(f.completeBaseName());
-                    int testNum = test.captured(0).toInt();
-                    num++;
-                    while (num < testNum)
-                    {
-                        _missingFrames << num;
-                        num++;
-                    }
-                    num = testNum;
-                }
-            }
+        bool incorrect = !sequence.isValid;
+        QString error = sequence.error;
 
-            //we've found the digits block
-            if (!incorrect)
+        //we've found the digits block
+        if (!incorrect)
+        {
+            qDebug() << "Found " + QString::number(sequence.frames.count()) + " frames.";
+            _frames = sequence.frames;
+            _bitrate = ( _size * 8 ) / ( _frames.count()/24.0 );
+            //update filename with dume convention
+            QString digitsBlock = "";
+            while(digitsBlock.count() < sequence.numDigits)
             {
-                qDebug() << "Found " + QString::number(tempFrames.count()) + " frames.";
-                error = "";
-                //list all files in the sequence matching the pattern, and compute size
-                _frames = tempFrames;
-                _bitrate = ( _size * 8 ) / ( _frames.count()/24.0 );
-                if (_videoStreams[0]->startNumber() == 999999999) _videoStreams[0]->setStartNumber(0);
-                //update filename with dume convention
-                QString digitsBlock = "";
-                while(digitsBlock.count() < digits.count())
-                {
-                    digitsBlock += "#";
-                }
-                _fileName = dirPath + "/" + left + "{" + digitsBlock + "}" + right + "." + extension;
-                qDebug() << "Naming scheme: " + _fileName;
-                break;
+                digitsBlock += "#";
             }
+            _fileName = dirPath + "/" + sequence.left + "{" + digitsBlock + "}" + sequence.right + "." + extension;
+            qDebug() << "Naming scheme: " + _fileName;
         }
 
         qDebug() << "Finished scanning file name.";
@@ -16,6 +16,8 @@
 #include "Renderer/audioinfo.h"
 #include "Renderer/videoinfo.h"
 #include "Renderer/streamreference.h"
+#include "Renderer/probeservice.h"
+#include "Renderer/sequencescanner.h"
 #include "duqf-utils/utils.h"
 
 class MediaInfo : public QObject
@@ -40,6 +42,17 @@ public:
      * @param mediaFilePath The media file. For a frame sequence, it can be any frame from the sequence
      */
     void update(QFileInfo mediaFile, bool silent = false);
+    /**
+     * @brief Updates all the information for this media file, without waiting for the analysis.
+     * The analysis is run by the ProbeService, changed() is emitted once it is available.
+     * @param mediaFile The media file. For a frame sequence, it can be any frame from the sequence
+     */
+    void updateAsync(QFileInfo mediaFile, bool silent = false);
+    /**
+     * @brief Checks if the media is waiting for its analysis
+     * @return
+     */
+    bool isProbing() const;
     void copyFrom(MediaInfo *other, bool updateFilename = false, bool silent = false);
 
     /**
@@ -53,6 +66,7 @@ public:
     QString exportPreset();
     void exportPreset(QString jsonPath);
     void loadPreset(QFileInfo presetFilePath, bool silent = false);
+    void loadPreset(QJsonObject mainObj, bool silent = false);
 
     //general
     QString info() const;
@@ -113,11 +127,13 @@ public:
     void setAepNumThreads(int aepNumThreads, bool silent = false);
     void setAepCompName(const QString &aepCompName, bool silent = false);
     void setAepRqindex(int aepRqindex, bool silent = false);
+    void setAepStartFrame(int aepStartFrame, bool silent = false);
     void setAeUseRQueue(bool aeUseRQueue, bool silent = false);
     bool isAep() const;
     QString aepCompName() const;
     int aepNumThreads() const;
     int aepRqindex() const;
+    int aepStartFrame() const;
     bool aeUseRQueue() const;
 
     //cache
@@ -133,6 +149,10 @@ public:
     void clearVideoStreams(bool silent = false);
     QList<VideoInfo *> videoStreams() const;
     QList<AudioInfo *> audioStreams() const;
+    /**
+     * @brief The number of subtitle streams in the media. They're not handled by DuME, but ffmpeg may select them by default.
+     */
+    int numSubtitleStreams() const;
 
     //maps
     QList<StreamReference> maps() const;
@@ -143,6 +163,16 @@ public:
     void setMapMedia(int mapIndex, int mediaId, bool silentt = false);
     void setMapStream(int mapIndex, int streamId, bool silentt = false);
 
+    //mirrors
+    /**
+     * @brief The other destinations of an output, where the same encoded file is written
+     * @return The file paths
+     */
+    QStringList mirrors() const;
+    void setMirrors(const QStringList &mirrors, bool silent = false);
+    void addMirror(QString path, bool silent = false);
+    void removeMirror(int index, bool silent = false);
+
     //stream setters
     //video
     void setStartNumber(int startNumber, int id = -1, bool silent = false);
@@ -216,12 +246,17 @@ public slots:
 
 private slots:
     void streamChanged();
+    void probeFinished(QString output);
 
 private:
     // ========== ATTRIBUTES ==============
 
     int _id;
 
+    // The analysis being run by the ProbeService, if any
+    ProbeJob *_probeJob;
+    bool _probeSilent;
+
     // GENERAL
 
     /**
@@ -283,7 +318,9 @@ private:
 
     QList<VideoInfo *> _videoStreams;
     QList<AudioInfo *> _audioStreams;
+    int _numSubtitleStreams;
     QList<StreamReference> _maps;
+    QStringList _mirrors;
 
     // GENERAL Encoding/decoding parameters
 
@@ -321,6 +358,10 @@ private:
      * @brief _aepRqindex The index of the render queue item in this After Effects project to render
      */
     int _aepRqindex;
+    /**
+     * @brief _aepStartFrame The first frame number of the composition to render, as displayed in After Effects. -1 if unknown.
+     */
+    int _aepStartFrame;
     /**
      * @brief _aeUseRQueue Wether to launch the render queue when rendering the After Effects project, or render a specific composition or renderqueue item.
      */
@@ -336,6 +377,25 @@ private:
      * @brief loadSequence Loads all the frames of the frame sequence
      */
     void loadSequence(bool silent = false);
+    /**
+     * @brief Resets the media and sets the file, before its analysis
+     * @return false if the file does not exist and there's nothing to analyse
+     */
+    bool prepareUpdate(QFileInfo mediaFile, bool silent = false);
+    /**
+     * @brief Reads the streams and information from the output of the prober
+     * @param probe The analysis, either the JSON from ffprobe or the output of ffmpeg
+     */
+    void parseProbe(QString probe, bool silent = false);
+    /**
+     * @brief Reads the streams and information from the JSON document printed by ffprobe
+     */
+    void parseFFprobe(QJsonObject probe, bool silent = false);
+    /**
+     * @brief Reads the streams and information from the output of ffmpeg, with regular expressions.
+     * Used when ffprobe is not available
+     */
+    void parseFFmpegProbe(QString ffmpegOutput, bool silent = false);
 
 };
 
@@ -0,0 +1,132 @@
+#include "outputtracker.h"
+
+// When the folder can't be watched, the minimum interval between two listings, in milliseconds
+#define POLL_INTERVAL 2000
+
+OutputTracker::OutputTracker(QObject *parent) : QObject(parent)
+{
+    _watcher = new QFileSystemWatcher(this);
+    connect(_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged()));
+    _watching = false;
+    _changed = false;
+    _size = 0;
+}
+
+void OutputTracker::setOutput(QString fileName)
+{
+    // Sequence
+    QRegularExpression regExDigits("({#+})");
+    if (fileName.contains(regExDigits))
+    {
+        QFileInfo info(fileName);
+        QString nameFilter = info.fileName();
+        nameFilter.replace(regExDigits, "*");
+        setOutput(info.path(), nameFilter);
+        return;
+    }
+
+    clear();
+    _fileName = fileName;
+}
+
+void OutputTracker::setOutput(QString dirPath, QString nameFilter)
+{
+    clear();
+    _dirPath = dirPath;
+    _nameFilter = nameFilter;
+
+    // The folder may not exist yet, in which case it is polled
+    if (QFileInfo::exists(dirPath)) _watching = _watcher->addPath(dirPath);
+    _changed = true;
+}
+
+void OutputTracker::clear()
+{
+    if (_watcher->directories().count() > 0) _watcher->removePaths(_watcher->directories());
+    _fileName = "";
+    _dirPath = "";
+    _nameFilter = "";
+    _watching = false;
+    _changed = false;
+    _sizes.clear();
+    _pending.clear();
+    _size = 0;
+    _lastListing.invalidate();
+}
+
+void OutputTracker::update()
+{
+    if (_fileName != "")
+    {
+        _size = QFileInfo(_fileName).size();
+        return;
+    }
+
+    if (_dirPath != "") updateSequence();
+}
+
+qint64 OutputTracker::size() const
+{
+    return _size;
+}
+
+int OutputTracker::numFiles() const
+{
+    if (_fileName != "") return _size > 0 ? 1 : 0;
+    return _sizes.count();
+}
+
+void OutputTracker::directoryChanged()
+{
+    _changed = true;
+    emit changed();
+}
+
+void OutputTracker::updateSequence()
+{
+    QSet<QString> newFiles;
+
+    if (!_watching && _lastListing.isValid() && _lastListing.elapsed() < POLL_INTERVAL) _changed = false;
+    else if (!_watching) _changed = true;
+
+    if (_changed)
+    {
+        _changed = false;
+        _lastListing.start();
+
+        // Only the names are needed to find the new files
+        QDir dir(_dirPath);
+        QStringList names = dir.entryList(QStringList(_nameFilter), QDir::Files, QDir::NoSort);
+
+        // Files have been removed, start again
+        if (names.count() < _sizes.count())
+        {
+            _sizes.clear();
+            _pending.clear();
+            _size = 0;
+        }
+
+        foreach(QString name, names)
+        {
+            if (_sizes.contains(name)) continue;
+            _sizes.insert(name, 0);
+            newFiles.insert(name);
+        }
+
+        // Try again to watch the folder if it did not exist
+        if (!_watching && QFileInfo::exists(_dirPath)) _watching = _watcher->addPath(_dirPath);
+    }
+
+    // Files which were being written the last time may have grown; once they don't change, they're done
+    QSet<QString> files = _pending;
+    files.unite(newFiles);
+    _pending.clear();
+    foreach(QString name, files)
+    {
+        qint64 previousSize = _sizes.value(name, 0);
+        qint64 fileSize = QFileInfo(_dirPath + "/" + name).size();
+        _sizes[name] = fileSize;
+        _size += fileSize - previousSize;
+        if (fileSize != previousSize || newFiles.contains(name)) _pending.insert(name);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef OUTPUTTRACKER_H
+#define OUTPUTTRACKER_H
+
+#include <QObject>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QHash>
+#include <QSet>
+#include <QtDebug>
+
+/**
+ * @brief The OutputTracker class keeps track of the size and number of files written by a renderer.
+ * For image sequences, the folder is watched and only the new frames (and the ones which may still be written) are read again;
+ * if the folder can't be watched, it is listed again at most every few seconds.
+ */
+class OutputTracker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OutputTracker(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts tracking a new output
+     * @param fileName The output file, or the sequence with {###} in place of the frame numbers
+     */
+    void setOutput(QString fileName);
+    /**
+     * @brief Starts tracking the files of a folder
+     * @param dirPath The folder
+     * @param nameFilter The wildcard matching the files (e.g. "DuME_*.exr")
+     */
+    void setOutput(QString dirPath, QString nameFilter);
+    /**
+     * @brief Stops tracking and resets the counts
+     */
+    void clear();
+    /**
+     * @brief Reads the changes since the last update
+     */
+    void update();
+    /**
+     * @brief The total size of the files, in Bytes, as of the last update
+     */
+    qint64 size() const;
+    /**
+     * @brief The number of files, as of the last update
+     */
+    int numFiles() const;
+
+signals:
+    /**
+     * @brief Emitted when the watched folder changes
+     */
+    void changed();
+
+private slots:
+    void directoryChanged();
+
+private:
+    QFileSystemWatcher *_watcher;
+    // The file, when the output is not a sequence
+    QString _fileName;
+    // The folder and the filter, when the output is a sequence
+    QString _dirPath;
+    QString _nameFilter;
+    // True if the folder is watched, otherwise it is polled
+    bool _watching;
+    // True if the folder has changed since it was last listed
+    bool _changed;
+    QElapsedTimer _lastListing;
+    // The size of the files found so far
+    QHash<QString, qint64> _sizes;
+    // The files which may still be written
+    QSet<QString> _pending;
+    qint64 _size;
+
+    void updateSequence();
+};
+
+#endif // OUTPUTTRACKER_H
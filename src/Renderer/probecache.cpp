@@ -0,0 +1,139 @@
+#include "probecache.h"
+
+ProbeCache::ProbeCache(QObject *parent) : QObject(parent)
+{
+    _cachePath = "";
+    _numInserts = 0;
+}
+
+ProbeCache *ProbeCache::instance()
+{
+    if (!_instance) _instance = new ProbeCache();
+    return _instance;
+}
+
+QString ProbeCache::probe(QFileInfo mediaFile, QString version)
+{
+    if (!isEnabled()) return "";
+
+    QString k = key(mediaFile, version);
+    QFile entryFile( entryPath(k) );
+    if (!entryFile.open(QIODevice::ReadOnly)) return "";
+    QJsonObject entry = QJsonDocument::fromJson( entryFile.readAll() ).object();
+    entryFile.close();
+
+    // The file name is just a hash, check this is the right entry
+    if (entry.value("key").toString() != k) return "";
+
+    // Keep track of the last use for eviction
+    if (entryFile.open(QIODevice::ReadWrite))
+    {
+        entryFile.setFileTime( QDateTime::currentDateTime(), QFileDevice::FileModificationTime );
+        entryFile.close();
+    }
+
+    qDebug().noquote() << "Probe cache hit: " + mediaFile.absoluteFilePath();
+
+    return entry.value("probe").toString();
+}
+
+void ProbeCache::insert(QFileInfo mediaFile, QString version, QString probe)
+{
+    if (!isEnabled()) return;
+    if (probe == "") return;
+
+    QString k = key(mediaFile, version);
+
+    QJsonObject entry;
+    entry.insert("key", k);
+    entry.insert("probe", probe);
+
+    // Write in a temp file and rename, other DuME instances may be reading the cache
+    QSaveFile entryFile( entryPath(k) );
+    if (!entryFile.open(QIODevice::WriteOnly)) return;
+    entryFile.write( QJsonDocument(entry).toJson(QJsonDocument::Compact) );
+    entryFile.commit();
+
+    _numInserts++;
+    if (_numInserts >= 100) evict();
+}
+
+void ProbeCache::setCacheDir(QString path)
+{
+    _cachePath = path;
+    QDir cacheDir(_cachePath);
+    if (!cacheDir.exists()) cacheDir.mkpath(".");
+}
+
+QDir ProbeCache::cacheDir() const
+{
+    return QDir(_cachePath);
+}
+
+bool ProbeCache::isEnabled()
+{
+    if (_cachePath == "") return false;
+    return _settings.value("probeCache/enabled", true).toBool();
+}
+
+void ProbeCache::evict()
+{
+    _numInserts = 0;
+    if (_cachePath == "") return;
+
+    // in MB
+    qint64 maxSize = _settings.value("probeCache/maxSize", 32).toLongLong() * 1024 * 1024;
+    // in days
+    int maxAge = _settings.value("probeCache/maxAge", 30).toInt();
+    QDateTime oldest = QDateTime::currentDateTime().addDays( -maxAge );
+
+    // Least recently used first
+    QDir cacheDir(_cachePath);
+    QFileInfoList entries = cacheDir.entryInfoList( QStringList("*.json"), QDir::Files, QDir::Time | QDir::Reversed );
+
+    qint64 cacheSize = 0;
+    foreach(QFileInfo entry, entries) cacheSize += entry.size();
+
+    int numRemoved = 0;
+    foreach(QFileInfo entry, entries)
+    {
+        bool tooOld = maxAge > 0 && entry.lastModified() < oldest;
+        bool tooBig = maxSize > 0 && cacheSize > maxSize;
+        // The next ones are more recent
+        if (!tooOld && !tooBig) break;
+
+        cacheSize -= entry.size();
+        QFile::remove( entry.absoluteFilePath() );
+        numRemoved++;
+    }
+
+    if (numRemoved > 0) qDebug().noquote() << "Probe cache: removed " + QString::number(numRemoved) + " entries.";
+}
+
+void ProbeCache::clear()
+{
+    if (_cachePath == "") return;
+    QDir cacheDir(_cachePath);
+    foreach(QFileInfo entry, cacheDir.entryInfoList( QStringList("*.json"), QDir::Files ))
+    {
+        QFile::remove( entry.absoluteFilePath() );
+    }
+}
+
+QString ProbeCache::key(QFileInfo mediaFile, QString version) const
+{
+    QStringList k;
+    k << mediaFile.absoluteFilePath();
+    k << QString::number( mediaFile.size() );
+    k << QString::number( mediaFile.lastModified().toMSecsSinceEpoch() );
+    k << version;
+    return k.join("|");
+}
+
+QString ProbeCache::entryPath(QString key) const
+{
+    QString hash = QCryptographicHash::hash( key.toUtf8(), QCryptographicHash::Sha1 ).toHex();
+    return _cachePath + "/" + hash + ".json";
+}
+
+ProbeCache *ProbeCache::_instance = nullptr;
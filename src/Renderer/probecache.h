@@ -0,0 +1,74 @@
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <QObject>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtDebug>
+
+/**
+ * @brief The ProbeCache class stores the analysis of the media files on disk,
+ * so that files which have already been probed don't need to be analysed again.
+ * Entries are keyed by the absolute path, size and modification date of the file, and the version of the prober.
+ */
+class ProbeCache : public QObject
+{
+    Q_OBJECT
+public:
+    static ProbeCache *instance();
+
+    /**
+     * @brief Gets the cached analysis of a media file
+     * @param mediaFile The file
+     * @param version The name and version of the prober which has generated the analysis
+     * @return The analysis, or an empty string if the file is not in the cache (or has changed since)
+     */
+    QString probe(QFileInfo mediaFile, QString version);
+    /**
+     * @brief Stores the analysis of a media file
+     * @param mediaFile The file
+     * @param version The name and version of the prober which has generated the analysis
+     * @param probe The analysis
+     */
+    void insert(QFileInfo mediaFile, QString version, QString probe);
+    /**
+     * @brief Sets the folder where the entries are stored. The cache is disabled until a folder is set.
+     * @param path The folder
+     */
+    void setCacheDir(QString path);
+    QDir cacheDir() const;
+    bool isEnabled();
+
+public slots:
+    /**
+     * @brief Removes the entries which are too old, then the least recently used ones until the cache is smaller than the maximum size
+     */
+    void evict();
+    /**
+     * @brief Removes all entries
+     */
+    void clear();
+
+private:
+    //private constructor, this is a singleton
+    explicit ProbeCache(QObject *parent = nullptr);
+    QString key(QFileInfo mediaFile, QString version) const;
+    QString entryPath(QString key) const;
+
+    QSettings _settings;
+    QString _cachePath;
+    // Number of entries added since the last eviction
+    int _numInserts;
+
+protected:
+    static ProbeCache *_instance;
+};
+
+#endif // PROBECACHE_H
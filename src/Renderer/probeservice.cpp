@@ -0,0 +1,168 @@
+#include "probeservice.h"
+
+ProbeJob::ProbeJob(QString mediaPath, QObject *parent) : QObject(parent)
+{
+    _mediaPath = mediaPath;
+    _output = "";
+    _finished = false;
+}
+
+QString ProbeJob::mediaPath() const
+{
+    return _mediaPath;
+}
+
+QString ProbeJob::output() const
+{
+    return _output;
+}
+
+bool ProbeJob::isFinished() const
+{
+    return _finished;
+}
+
+void ProbeJob::finish(QString output)
+{
+    if (_finished) return;
+    _output = output;
+    _finished = true;
+    emit finished(_output);
+    deleteLater();
+}
+
+ProbeService::ProbeService(QObject *parent) : QObject(parent)
+{
+
+}
+
+ProbeService *ProbeService::instance()
+{
+    if (!_instance) _instance = new ProbeService();
+    return _instance;
+}
+
+ProbeJob *ProbeService::probe(QString mediaPath)
+{
+    // Don't analyse the same file twice at the same time
+    ProbeJob *j = job(mediaPath);
+    if (j) return j;
+
+    j = new ProbeJob(mediaPath, this);
+
+    // Files which have already been analysed are in the cache
+    QString output = ProbeCache::instance()->probe( QFileInfo(mediaPath), FFmpeg::instance()->probeVersion() );
+    if (output != "")
+    {
+        // Always answer asynchronously, the caller has to be able to connect the job first
+        QTimer::singleShot(0, j, [j, output] { j->finish(output); });
+        return j;
+    }
+
+    _waitingJobs << j;
+    emit pendingProbesChanged( pendingProbes() );
+    launchJobs();
+
+    return j;
+}
+
+int ProbeService::maxProcesses()
+{
+    int max = _settings.value("probe/maxProcesses", 0).toInt();
+    if (max <= 0) max = QThread::idealThreadCount();
+    if (max <= 0) max = 1;
+    return max;
+}
+
+void ProbeService::setMaxProcesses(int max)
+{
+    _settings.setValue("probe/maxProcesses", max);
+    launchJobs();
+}
+
+int ProbeService::pendingProbes() const
+{
+    return _waitingJobs.count() + _runningJobs.count();
+}
+
+bool ProbeService::isBusy() const
+{
+    return pendingProbes() > 0;
+}
+
+void ProbeService::processFinished()
+{
+    QProcess *process = qobject_cast<QProcess*>( sender() );
+    if (!process) return;
+
+    QString output = QString::fromUtf8( process->readAllStandardOutput() );
+    // The process may have been killed after the timeout
+    if (process->exitStatus() == QProcess::CrashExit) output = "";
+    finishProcess( process, output );
+}
+
+void ProbeService::processError(QProcess::ProcessError e)
+{
+    // Other errors are followed by the finished signal
+    if (e != QProcess::FailedToStart) return;
+    QProcess *process = qobject_cast<QProcess*>( sender() );
+    if (!process) return;
+    finishProcess( process, "" );
+}
+
+void ProbeService::launchJobs()
+{
+    while( !_waitingJobs.isEmpty() && _runningJobs.count() < maxProcesses() )
+    {
+        ProbeJob *j = _waitingJobs.takeFirst();
+
+        // Each job has its own process, they're all running in parallel
+        QProcess *process = new QProcess(this);
+        // ffprobe prints its JSON on stdout, ffmpeg prints the analysis in its logs
+        if (FFmpeg::instance()->hasFFprobe()) process->setProcessChannelMode(QProcess::SeparateChannels);
+        else process->setProcessChannelMode(QProcess::MergedChannels);
+        process->setProgram( FFmpeg::instance()->probeBinary() );
+        process->setArguments( FFmpeg::instance()->probeArguments( j->mediaPath() ) );
+        connect(process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(processFinished()));
+        connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(processError(QProcess::ProcessError)));
+
+        // Kill the probes which don't respond
+        QTimer *timeout = new QTimer(process);
+        timeout->setSingleShot(true);
+        connect(timeout, &QTimer::timeout, process, &QProcess::kill);
+        timeout->start( _settings.value("probe/timeout", 10000).toInt() );
+
+        _runningJobs.insert(process, j);
+        process->start(QIODevice::ReadOnly);
+    }
+}
+
+void ProbeService::finishProcess(QProcess *process, QString output)
+{
+    ProbeJob *j = _runningJobs.take(process);
+    process->deleteLater();
+    if (!j) return;
+
+    // Only keep successful analysis
+    if (FFmpeg::instance()->isValidProbe(output)) ProbeCache::instance()->insert( QFileInfo(j->mediaPath()), FFmpeg::instance()->probeVersion(), output );
+
+    j->finish(output);
+
+    emit pendingProbesChanged( pendingProbes() );
+    launchJobs();
+}
+
+ProbeJob *ProbeService::job(QString mediaPath)
+{
+    foreach(ProbeJob *j, _waitingJobs)
+    {
+        if (j->mediaPath() == mediaPath) return j;
+    }
+    foreach(ProbeJob *j, _runningJobs)
+    {
+        if (j->mediaPath() == mediaPath) return j;
+    }
+    return nullptr;
+}
+
+ProbeService *ProbeService::_instance = nullptr;
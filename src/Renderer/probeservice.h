@@ -0,0 +1,111 @@
+#ifndef PROBESERVICE_H
+#define PROBESERVICE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QSettings>
+#include <QTimer>
+#include <QThread>
+#include <QHash>
+#include <QFileInfo>
+
+#include "FFmpeg/ffmpeg.h"
+#include "Renderer/probecache.h"
+
+/**
+ * @brief The ProbeJob class is the pending result of an analysis launched by the ProbeService.
+ * Connect to finished() to get the result; the job is deleted by the service right after it has been emitted.
+ */
+class ProbeJob : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProbeJob(QString mediaPath, QObject *parent = nullptr);
+
+    QString mediaPath() const;
+    /**
+     * @brief The output of the prober, empty until the job is finished or if the analysis has failed
+     * @return
+     */
+    QString output() const;
+    bool isFinished() const;
+
+signals:
+    /**
+     * @brief Emitted once the analysis is available
+     * @param output The output of the prober, empty if the analysis has failed
+     */
+    void finished( QString output );
+
+private:
+    friend class ProbeService;
+    void finish(QString output);
+
+    QString _mediaPath;
+    QString _output;
+    bool _finished;
+};
+
+/**
+ * @brief The ProbeService class analyses media files asynchronously,
+ * running the probes in a bounded pool of processes so the UI is never blocked.
+ */
+class ProbeService : public QObject
+{
+    Q_OBJECT
+public:
+    static ProbeService *instance();
+
+    /**
+     * @brief Queues the analysis of a media file
+     * @param mediaPath The path to the media file
+     * @return The job, which emits finished() when the analysis is available (even if it comes from the ProbeCache)
+     */
+    ProbeJob *probe(QString mediaPath);
+    /**
+     * @brief The maximum number of probes running at the same time
+     * @return
+     */
+    int maxProcesses();
+    /**
+     * @brief Sets the maximum number of probes running at the same time.
+     * @param max 0 to use the number of CPU cores
+     */
+    void setMaxProcesses(int max);
+    /**
+     * @brief The number of analysis waiting or running
+     * @return
+     */
+    int pendingProbes() const;
+    bool isBusy() const;
+
+signals:
+    /**
+     * @brief Emitted when a probe is queued or finished
+     * @param pendingProbes The number of analysis waiting or running
+     */
+    void pendingProbesChanged( int pendingProbes );
+
+private slots:
+    void processFinished();
+    void processError(QProcess::ProcessError e);
+
+private:
+    //private constructor, this is a singleton
+    explicit ProbeService(QObject *parent = nullptr);
+    // launches the waiting jobs while there are free processes
+    void launchJobs();
+    // ends the job of the process and launches the next ones
+    void finishProcess(QProcess *process, QString output);
+    // gets the job already analysing this file, if any
+    ProbeJob *job(QString mediaPath);
+
+    QSettings _settings;
+    QList<ProbeJob*> _waitingJobs;
+    QHash<QProcess*, ProbeJob*> _runningJobs;
+
+protected:
+    static ProbeService *_instance;
+};
+
+#endif // PROBESERVICE_H
@@ -5,6 +5,7 @@ QueueItem::QueueItem(QObject *parent) : QObject(parent)
     _inputMedias = new MediaList(this);
     _outputMedias = new MediaList(this);
     _status = MediaUtils::Waiting;
+    _priority = 0;
 }
 
 QueueItem::QueueItem(MediaList *inputs, MediaList *outputs, QObject *parent) : QObject(parent)
@@ -12,6 +13,7 @@ QueueItem::QueueItem(MediaList *inputs, MediaList *outputs, QObject *parent) : Q
     _inputMedias = inputs;
     _outputMedias = outputs;
     _status = MediaUtils::Waiting;
+    _priority = 0;
 }
 
 QueueItem::QueueItem(QList<MediaInfo *> inputs, QList<MediaInfo *> outputs, QObject *parent) : QObject(parent)
@@ -27,6 +29,7 @@ QueueItem::QueueItem(QList<MediaInfo *> inputs, QList<MediaInfo *> outputs, QObj
         addOutputMedia(o);
     }
     _status = MediaUtils::Waiting;
+    _priority = 0;
 }
 
 QueueItem::QueueItem(MediaInfo *input, QList<MediaInfo *> outputs, QObject *parent) : QObject(parent)
@@ -39,6 +42,7 @@ QueueItem::QueueItem(MediaInfo *input, QList<MediaInfo *> outputs, QObject *pare
         addOutputMedia(o);
     }
     _status = MediaUtils::Waiting;
+    _priority = 0;
 }
 
 QueueItem::QueueItem(MediaInfo *input, MediaInfo *output, QObject *parent) : QObject(parent)
@@ -48,6 +52,7 @@ QueueItem::QueueItem(MediaInfo *input, MediaInfo *output, QObject *parent) : QOb
     addInputMedia(input);
     addOutputMedia(output);
     _status = MediaUtils::Waiting;
+    _priority = 0;
 }
 
 QueueItem::~QueueItem()
@@ -124,6 +129,16 @@ MediaUtils::RenderStatus QueueItem::status()
     return _status;
 }
 
+int QueueItem::priority() const
+{
+    return _priority;
+}
+
+void QueueItem::setPriority(int priority)
+{
+    _priority = priority;
+}
+
 void QueueItem::setStatus( MediaUtils::RenderStatus st )
 {
     if(_status == st) return;
@@ -27,6 +27,12 @@ public:
     MediaInfo *takeOutputMedia(int id);
     MediaInfo *takeOutputMedia(QString fileName);
     MediaUtils::RenderStatus status();
+    /**
+     * @brief The priority of the item in the render queue. Items with a higher priority are rendered first.
+     * @return The priority, 0 by default
+     */
+    int priority() const;
+    void setPriority(int priority);
 
 public slots:
     /**
@@ -45,6 +51,7 @@ private:
     MediaList *_inputMedias;
     MediaList *_outputMedias;
     MediaUtils::RenderStatus _status;
+    int _priority;
 };
 
 #endif // FFQUEUEITEM_H
@@ -13,25 +13,19 @@ RenderQueue::RenderQueue(QObject *parent ) : QObject(parent)
 {
     setStatus( MediaUtils::Initializing );
 
-    // === FFmpeg ===
-
-    // The transcoder
-    // Create the renderer
-    _ffmpegRenderer = FFmpegRenderer::instance();
-    _ffmpegRenderer->setBinary( FFmpeg::instance()->binary() );
-    // Connections
-    connect( FFmpeg::instance(), &FFmpeg::binaryChanged, _ffmpegRenderer, &FFmpegRenderer::setBinary ) ;
-    connect( _ffmpegRenderer, &FFmpegRenderer::statusChanged, this, &RenderQueue::ffmpegStatusChanged ) ;
-    connect( _ffmpegRenderer, &FFmpegRenderer::progress, this, &RenderQueue::ffmpegProgress ) ;
-    _ffmpegRenderer->setStopCommand("q\n");
-
-    // === After Effects ===
-
-    // Create the renderer
-    _aeRenderer = AERenderer::instance();
-    // Connections
-    connect( _aeRenderer, &AERenderer::statusChanged, this, &RenderQueue::aeStatusChanged ) ;
-    connect( _aeRenderer, &AERenderer::progress, this, &RenderQueue::aeProgress ) ;
+    _running = false;
+    _maxJobsOverride = -1;
+
+    _numFrames = 0;
+    _frameRate = 24;
+    _currentFrame = 0;
+    _outputSize = 0;
+    _outputBitrate = 0;
+    _expectedSize = 0;
+    _encodingSpeed = 0;
+    _startTime = QTime::currentTime();
+    _remainingTime = QTime(0,0,0,0);
+    _elapsedTime = QTime(0,0,0,0);
 
     // A timer to keep track of the rendering process
     timer = new QTimer( this );
@@ -43,7 +37,6 @@ RenderQueue::RenderQueue(QObject *parent ) : QObject(parent)
 RenderQueue::~RenderQueue()
 {
     stop(100);
-    postRenderCleanUp();
 }
 
 void RenderQueue::setStatus(MediaUtils::RenderStatus st)
@@ -53,60 +46,58 @@ void RenderQueue::setStatus(MediaUtils::RenderStatus st)
     emit statusChanged(_status);
 }
 
-void RenderQueue::ffmpegStatusChanged( MediaUtils::RenderStatus status )
+void RenderQueue::slotStatusChanged()
 {
-    if ( MediaUtils::isBusy( status ) )
-    {
-        setStatus( MediaUtils::FFmpegEncoding );
-        emit newLog("FFmpeg is running.");
-    }
-    else if ( status == MediaUtils::Finished )
-    {
-        emit newLog("FFmpeg Transcoding process finished.");
-        postRenderCleanUp( MediaUtils::Finished );
-    }
-    else if ( status == MediaUtils::Stopped )
-    {
-        emit newLog("FFmpeg transcoding has been stopped.");
-        postRenderCleanUp( MediaUtils::Stopped );
-    }
-    else if ( status == MediaUtils::Error )
+    updateStatus();
+}
+
+void RenderQueue::slotProgress()
+{
+    // Aggregate the progress of all running slots
+    _numFrames = 0;
+    _currentFrame = 0;
+    _outputSize = 0;
+    _outputBitrate = 0;
+    _expectedSize = 0;
+    _encodingSpeed = 0;
+    int remainingSeconds = 0;
+
+    foreach(RenderSlot *slot, _slots)
     {
-        emit newLog("An unexpected FFmpeg error has occured.", LogUtils::Critical );
-        postRenderCleanUp( MediaUtils::Error );
+        if (!slot->isBusy()) continue;
+        AbstractRenderer *renderer = slot->activeRenderer();
+        _numFrames += renderer->numFrames();
+        _currentFrame += renderer->currentFrame();
+        _frameRate = renderer->frameRate();
+        _outputSize += renderer->outputSize();
+        _outputBitrate += renderer->outputBitrate();
+        _expectedSize += renderer->expectedSize();
+        _encodingSpeed += renderer->encodingSpeed();
+        int remaining = QTime(0,0).secsTo( renderer->timeRemaining() );
+        if (remaining > remainingSeconds) remainingSeconds = remaining;
     }
+
+    _remainingTime = QTime(0,0).addSecs( remainingSeconds );
+    _elapsedTime = QTime(0,0).addSecs( _startTime.secsTo( QTime::currentTime() ) );
+
+    emit progress();
 }
 
-void RenderQueue::ffmpegProgress()
+void RenderQueue::itemDestroyed(QObject *item)
 {
-    //Relay progress information
-    _numFrames = _ffmpegRenderer->numFrames();
-    _frameRate = _ffmpegRenderer->frameRate();
-    _currentFrame = _ffmpegRenderer->currentFrame();
-    _startTime = _ffmpegRenderer->startTime();
-    _outputSize = _ffmpegRenderer->outputSize();
-    _outputBitrate = _ffmpegRenderer->outputBitrate();
-    _expectedSize = _ffmpegRenderer->expectedSize();
-    _encodingSpeed = _ffmpegRenderer->encodingSpeed();
-    _remainingTime = _ffmpegRenderer->timeRemaining();
-    _elapsedTime = _ffmpegRenderer->elapsedTime();
-    emit progress();
+    _encodingHistory.removeAll( static_cast<QueueItem*>(item) );
 }
 
-void RenderQueue::aeProgress()
+void RenderQueue::slotItemFinished(QueueItem *item, MediaUtils::RenderStatus lastStatus)
 {
-    //Relay progress information
-    _numFrames = _aeRenderer->numFrames();
-    _frameRate = _aeRenderer->frameRate();
-    _currentFrame = _aeRenderer->currentFrame();
-    _startTime = _aeRenderer->startTime();
-    _outputSize = _aeRenderer->outputSize();
-    _outputBitrate = _aeRenderer->outputBitrate();
-    _expectedSize = _aeRenderer->expectedSize();
-    _encodingSpeed = _aeRenderer->encodingSpeed();
-    _remainingTime = _aeRenderer->timeRemaining();
-    _elapsedTime = _aeRenderer->elapsedTime();
-    emit progress();
+    emit newLog( "Item finished: " + MediaUtils::RenderStatusToHumanString( lastStatus ) );
+
+    //move to history
+    _encodingHistory << item;
+    connect( item, SIGNAL(destroyed(QObject*)), this, SLOT(itemDestroyed(QObject*)) );
+
+    if (_running) encodeNextItem();
+    else updateStatus();
 }
 
 QTime RenderQueue::elapsedTime() const
@@ -156,30 +147,67 @@ MediaUtils::RenderStatus RenderQueue::status() const
 
 QueueItem *RenderQueue::currentItem()
 {
-    return _currentItem;
+    foreach(RenderSlot *slot, _slots)
+    {
+        if (slot->isBusy()) return slot->currentItem();
+    }
+    return nullptr;
+}
+
+AbstractRenderer *RenderQueue::itemRenderer(QueueItem *item) const
+{
+    foreach(RenderSlot *slot, _slots)
+    {
+        if (slot->currentItem() == item) return slot->activeRenderer();
+    }
+    return nullptr;
+}
+
+QList<QueueItem *> RenderQueue::currentItems()
+{
+    QList<QueueItem *> items;
+    foreach(RenderSlot *slot, _slots)
+    {
+        if (slot->isBusy()) items << slot->currentItem();
+    }
+    return items;
 }
 
 void RenderQueue::encode()
 {
-    if (_status == MediaUtils::FFmpegEncoding || _status == MediaUtils::AERendering  || _status == MediaUtils::BlenderRendering ) return;
+    if (_encodingQueue.count() == 0) return;
 
-    setStatus( MediaUtils::Launching );
-    //launch first item
+    // Starting from scratch, reset the timer
+    if ( !MediaUtils::isBusy( _status ) ) _startTime = QTime::currentTime();
+
+    _running = true;
+    //launch as many items as possible
     encodeNextItem();
 }
 
 void RenderQueue::encode(QueueItem *item)
 {
-    clearQueue();
-    _encodingQueue << item;
+    addQueueItem( item );
+    encode();
+}
+
+void RenderQueue::encode(QList<QueueItem *> list)
+{
+    foreach(QueueItem *item, list) addQueueItem( item );
     encode();
 }
 
 int RenderQueue::addQueueItem(QueueItem *item)
 {
-    clearQueue();
-    _encodingQueue << item;
-    return _encodingQueue.count()-1;
+    // Already waiting or running
+    if (_encodingQueue.contains(item)) return _encodingQueue.indexOf(item);
+    if (currentItems().contains(item)) return -1;
+
+    // Keep the queue sorted by priority, in the order the items were added for the same priority
+    int id = _encodingQueue.count();
+    while (id > 0 && _encodingQueue.at(id-1)->priority() < item->priority()) id--;
+    _encodingQueue.insert(id, item);
+    return id;
 }
 
 void RenderQueue::deleteQueueItem(int id)
@@ -210,13 +238,11 @@ void RenderQueue::stop(int timeout)
 {
     emit newLog( "Stopping queue" );
 
-    if ( _status == MediaUtils::FFmpegEncoding )
-    {
-        _ffmpegRenderer->stop( timeout );
-    }
-    else if ( _status == MediaUtils::AERendering )
+    _running = false;
+
+    foreach(RenderSlot *slot, _slots)
     {
-        _aeRenderer->stop( timeout );
+        if (slot->isBusy()) slot->stop( timeout );
     }
 
     setStatus( MediaUtils::Waiting );
@@ -224,127 +250,155 @@ void RenderQueue::stop(int timeout)
     emit newLog( "Queue stopped" );
 }
 
-void RenderQueue::postRenderCleanUp( MediaUtils::RenderStatus lastStatus )
+int RenderQueue::maxConcurrentJobs()
 {
-    if (_status == MediaUtils::FFmpegEncoding || _status == MediaUtils::AERendering || _status == MediaUtils::BlenderRendering )
-    {
-        setStatus( MediaUtils::Cleaning );
-
-        //restore ae templates TODO run more tests for this
-        if ( _status == MediaUtils::AERendering && AERenderer::instance()->isUsingTemplates() ) _ae->restoreOriginalTemplates();
-
-        finishCurrentItem( lastStatus );
+    if (_maxJobsOverride >= 0) return _maxJobsOverride;
+    return settings.value("renderqueue/maxJobs", 0).toInt();
+}
 
-        encodeNextItem();
-    }
-    else
-    {
-        setStatus( lastStatus );
-    }
+void RenderQueue::setMaxConcurrentJobs(int maxJobs)
+{
+    settings.setValue("renderqueue/maxJobs", maxJobs);
+    settings.sync();
+    // Use the new slots right away
+    if (_running) encodeNextItem();
 }
 
-void RenderQueue::encodeNextItem()
+void RenderQueue::setMaxConcurrentJobsOverride(int maxJobs)
 {
-    if (_encodingQueue.count() == 0)
-    {
-        setStatus( MediaUtils::Waiting );
-        return;
-    }
+    _maxJobsOverride = maxJobs;
+    if (_running) encodeNextItem();
+}
 
-    _currentItem = _encodingQueue.takeAt(0);
+int RenderQueue::threadCost(QueueItem *item)
+{
+    int numCores = QThread::idealThreadCount();
+    if (numCores < 1) numCores = 1;
 
-    setStatus( MediaUtils::Launching );
+    // After Effects takes the whole machine
+    if (usesAfterEffects(item)) return numCores;
 
-    //Check if there are AEP to render
-    if (_aeRenderer->render( _currentItem ) ) return;
+    int cost = 0;
+    foreach(MediaInfo *output, item->getOutputMedias())
+    {
+        if (output->hasVideo())
+        {
+            VideoInfo *stream = output->videoStreams().at(0);
+            FFCodec *codec = stream->codec();
+            if (codec == nullptr || codec->name() == "") codec = output->defaultVideoCodec();
+
+            // Stream copy: just I/O
+            if (stream->isCopy()) cost += 1;
+            // Image encoders (png, dpx, tiff...) are single-threaded
+            else if (output->isSequence()) cost += 2;
+            // Intra-frame codecs (prores, dnxhd...) use slice threading which does not scale much
+            else if (codec == nullptr || codec->isIframe()) cost += 4;
+            // Long GOP encoders (h264, h265...) use frame threading, efficient up to ~16 threads
+            else cost += qMin(numCores, 16);
+        }
+        else if (output->hasAudio())
+        {
+            cost += 1;
+        }
+    }
 
-    //Now all aep are rendered, transcode with ffmpeg
-    _ffmpegRenderer->render( _currentItem );
+    return qBound(1, cost, numCores);
 }
 
-void RenderQueue::finishCurrentItem( MediaUtils::RenderStatus lastStatus )
+bool RenderQueue::usesAfterEffects(QueueItem *item)
 {
-    if (_currentItem == nullptr) return;
-    _currentItem->setStatus( lastStatus );
-    _currentItem->postRenderCleanUp();
-    //move to history
-    _encodingHistory << _currentItem;
-    _currentItem = nullptr;
+    foreach(MediaInfo *input, item->getInputMedias())
+    {
+        if (input->isAep()) return true;
+    }
+    return false;
 }
 
-void RenderQueue::aeStatusChanged( MediaUtils::RenderStatus status )
+void RenderQueue::encodeNextItem()
 {
-    if ( MediaUtils::isBusy( status ) )
+    while (_running && _encodingQueue.count() > 0)
     {
-        setStatus( MediaUtils::AERendering );
-        emit newLog("After Effects is running.");
+        RenderSlot *slot = availableSlot( _encodingQueue.at(0) );
+        if (slot == nullptr) break;
+
+        QueueItem *item = _encodingQueue.takeAt(0);
+        slot->render( item );
     }
-    else if ( status == MediaUtils::Finished )
-    {
-        MediaInfo *input = _currentItem->getInputMedias()[0];
 
-        emit newLog("After Effects Render process successfully finished");
+    updateStatus();
+}
 
-        //encode rendered EXR
-        if (!input->aeUseRQueue())
-        {
-            //Remove Temp AEP
-            if (settings.value("aerender/removeAep", true).toBool())
-            {
-                QFileInfo aep(input->fileName());
-                QDir aepFolder = aep.dir();
-                if (aepFolder.dirName() == "DuME aep") aepFolder.removeRecursively();
-            }
-
-            //set exr
-            //get one file
-            QString aeTempPath = input->cacheDir()->path();
-            QDir aeTempDir(aeTempPath);
-            QStringList filters("DuME_*.exr");
-            QStringList files = aeTempDir.entryList(filters,QDir::Files | QDir::NoDotAndDotDot);
-
-            //if nothing has been rendered, set to error and go on with next queue item
-            if (files.count() == 0)
-            {
-                postRenderCleanUp( MediaUtils::Error );
-                return;
-            }
-
-            //set file and launch
-            //frames
-            double frameRate = input->videoStreams()[0]->framerate();
-            //block signals: we don't want to change any output parameter connected to the input
-            QSignalBlocker b(input);
-            input->update( QFileInfo(aeTempPath + "/" + files[0]));
-            if (int( frameRate ) != 0) input->videoStreams()[0]->setFramerate(frameRate);
-            //add audio
-            QFileInfo audioFile(aeTempPath + "/DuME.wav");
-            if (audioFile.exists())
-            {
-                MediaInfo *audio = new MediaInfo(audioFile, this);
-                _currentItem->addInputMedia(audio);
-            }
-
-            //reInsert at first place in renderqueue
-            _encodingQueue.insert(0,_currentItem);
-            //and go
-            encodeNextItem();
-        }
-        else
+RenderSlot *RenderQueue::availableSlot(QueueItem *item)
+{
+    int runningJobs = 0;
+    int usedCores = 0;
+    bool runningAe = false;
+    RenderSlot *freeSlot = nullptr;
+
+    foreach(RenderSlot *slot, _slots)
+    {
+        if (slot->isBusy())
         {
-            emit newLog("After Effects Rendering process successfully finished.");
-            postRenderCleanUp( MediaUtils::Finished );
+            runningJobs++;
+            usedCores += threadCost( slot->currentItem() );
+            if (usesAfterEffects( slot->currentItem() )) runningAe = true;
         }
+        else if (freeSlot == nullptr) freeSlot = slot;
     }
-    else if ( status == MediaUtils::Stopped )
+
+    // Launch while there are cores available, but always at least one job
+    bool noCoreLeft = runningJobs > 0 && usedCores + threadCost( item ) > QThread::idealThreadCount();
+
+    int maxJobs = maxConcurrentJobs();
+    if (maxJobs > 0)
     {
-        emit newLog("After Effects rendering has been stopped.");
-        postRenderCleanUp( MediaUtils::Stopped );
+        if (runningJobs >= maxJobs) return nullptr;
+        // After Effects takes the whole machine, even with a fixed number of jobs
+        if (noCoreLeft && (runningAe || usesAfterEffects( item ))) return nullptr;
     }
-    else if ( status == MediaUtils::Error )
+    // Auto
+    else if (noCoreLeft)
     {
-        emit newLog("An unexpected After Effects error has occured.", LogUtils::Critical);
-        postRenderCleanUp( MediaUtils::Error );
+        return nullptr;
     }
+
+    if (freeSlot != nullptr) return freeSlot;
+
+    // Create a new worker
+    freeSlot = new RenderSlot( _slots.count(), this );
+    connect( freeSlot, &RenderSlot::statusChanged, this, &RenderQueue::slotStatusChanged );
+    connect( freeSlot, &RenderSlot::progress, this, &RenderQueue::slotProgress );
+    connect( freeSlot, &RenderSlot::itemFinished, this, &RenderQueue::slotItemFinished );
+    connect( freeSlot, &RenderSlot::newLog, this, &RenderQueue::newLog );
+    connect( freeSlot->ffmpegRenderer(), &AbstractRenderer::console, this, &RenderQueue::ffmpegConsole );
+    connect( freeSlot->ffmpegRenderer(), &AbstractRenderer::newLog, this, &RenderQueue::ffmpegLog );
+    connect( freeSlot->aeRenderer(), &AbstractRenderer::console, this, &RenderQueue::aeConsole );
+    connect( freeSlot->aeRenderer(), &AbstractRenderer::newLog, this, &RenderQueue::aeLog );
+    _slots << freeSlot;
+
+    emit newLog( "Render slot " + QString::number( _slots.count() ) + " created.", LogUtils::Debug );
+
+    return freeSlot;
 }
 
+void RenderQueue::updateStatus()
+{
+    // When stopped, the slots are just cleaning up
+    if (!_running) return;
+
+    MediaUtils::RenderStatus st = MediaUtils::Waiting;
+    foreach(RenderSlot *slot, _slots)
+    {
+        MediaUtils::RenderStatus slotStatus = slot->status();
+        if ( slotStatus == MediaUtils::AERendering ) st = MediaUtils::AERendering;
+        else if ( slotStatus == MediaUtils::FFmpegEncoding && st != MediaUtils::AERendering ) st = MediaUtils::FFmpegEncoding;
+        else if ( MediaUtils::isBusy( slotStatus ) && st == MediaUtils::Waiting ) st = MediaUtils::Launching;
+    }
+
+    // Items are still waiting to be launched
+    if ( st == MediaUtils::Waiting && _encodingQueue.count() > 0 ) st = MediaUtils::Launching;
+    // Everything has been rendered
+    if ( st == MediaUtils::Waiting ) _running = false;
+
+    setStatus( st );
+}
@@ -4,17 +4,20 @@
 #include <QObject>
 #include <QDebug>
 #include <QTimer>
+#include <QThread>
 
 #include "FFmpeg/ffmpegrenderer.h"
 #include "AfterEffects/aerenderer.h"
 #include "FFmpeg/ffmpeg.h"
 #include "AfterEffects/aftereffects.h"
 #include "Renderer/cachemanager.h"
+#include "Renderer/renderslot.h"
 
 #include "queueitem.h"
 
 /**
  * @brief The Renderer class handles the render queue and render processes (ffmpeg, After Effects, Blender...)
+ * The items are rendered concurrently by a pool of RenderSlot workers.
  */
 class RenderQueue : public QObject
 {
@@ -32,9 +35,20 @@ public:
 
     /**
      * @brief Gets the item currently being encoded
-     * @return The queue item
+     * @return The queue item, the first one if several items are being encoded
      */
     QueueItem *currentItem();
+    /**
+     * @brief Gets all the items currently being encoded
+     * @return The queue items
+     */
+    QList<QueueItem *> currentItems();
+    /**
+     * @brief Gets the renderer working on an item, to get its progress
+     * @param item The item
+     * @return The renderer, or nullptr if the item is not being encoded
+     */
+    AbstractRenderer *itemRenderer(QueueItem *item) const;
     /**
      * @brief encode Launches the encoding of the current queue
      */
@@ -50,7 +64,7 @@ public:
      */
     void encode(QList<QueueItem*> list);
     /**
-     * @brief addQueueItem Adds an item to the encoding queue
+     * @brief addQueueItem Adds an item to the encoding queue, after the items with the same or a higher priority
      * @param item
      * @return The item id
      */
@@ -81,6 +95,34 @@ public:
      */
     void stop(int timeout = 10000);
 
+    // CONCURRENCY
+
+    /**
+     * @brief The maximum number of items encoded at the same time
+     * @return The number of jobs, or 0 to compute it automatically from the number of cores and the codecs used
+     */
+    int maxConcurrentJobs();
+    /**
+     * @brief Sets the maximum number of items encoded at the same time
+     * @param maxJobs The number of jobs, 0 to compute it automatically from the number of cores and the codecs used
+     */
+    void setMaxConcurrentJobs(int maxJobs);
+    /**
+     * @brief Overrides the maximum number of items encoded at the same time for this process only, without changing the settings
+     * @param maxJobs The number of jobs, 0 to compute it automatically, -1 to use the settings again
+     */
+    void setMaxConcurrentJobsOverride(int maxJobs);
+    /**
+     * @brief Estimates the number of cores an item will use while being encoded
+     * @param item The item
+     * @return The number of cores
+     */
+    static int threadCost(QueueItem *item);
+    /**
+     * @brief Checks if an item has to be rendered by After Effects, which takes the whole machine
+     */
+    static bool usesAfterEffects(QueueItem *item);
+
     // PROGRESS INFO
 
     /**
@@ -135,6 +177,8 @@ signals:
     void newLog( QString, LogUtils::LogType lt = LogUtils::Information );
     void ffmpegConsole( QString );
     void aeConsole( QString );
+    void ffmpegLog( QString, LogUtils::LogType lt = LogUtils::Information );
+    void aeLog( QString, LogUtils::LogType lt = LogUtils::Information );
 
     // === QUEUE ===
 
@@ -147,17 +191,13 @@ private slots:
     // changes the current status (and emits statusChanged)
     void setStatus(MediaUtils::RenderStatus st);
 
-    // === ffmpeg ===
-
-    // logs ffmpeg output
-    void ffmpegStatusChanged(MediaUtils::RenderStatus status);
-    void ffmpegProgress();
-
-    // === Ae ===
+    // === Slots ===
 
-    // logs ae output
-    void aeStatusChanged(MediaUtils::RenderStatus status);
-    void aeProgress();
+    void slotStatusChanged();
+    void slotProgress();
+    void slotItemFinished(QueueItem *item, MediaUtils::RenderStatus lastStatus);
+    // removes deleted items from the history
+    void itemDestroyed(QObject *item);
 
 private:
     /**
@@ -181,24 +221,19 @@ private:
     QList<QueueItem *> _encodingQueue;
     // All the items previously encoded
     QList<QueueItem *> _encodingHistory;
-    // The item currently encoding
-    QueueItem *_currentItem;
-
-    // ========== FFMPEG ============
-
-    // The FFmpeg transcoder
-    FFmpegRenderer *_ffmpegRenderer;
+    // True while the queue has to launch its items
+    bool _running;
+    // The maximum number of jobs set for this process only, -1 to use the settings
+    int _maxJobsOverride;
 
-    // ======= AFTER EFFECTS ========
+    // ======= WORKERS =============
 
-    // The After Effects renderer info
-    AfterEffects *_ae;
-    // The After Effects renderer //TODO create a singleton like ffmpeg
-    AERenderer *_aeRenderer;
+    // The render slots, each one encodes an item
+    QList<RenderSlot *> _slots;
 
     // ======= RENDERING PROCESS ========
 
-    //TODO some of these info should be moved to the renderers
+    // Aggregated progress of all the slots
 
     // the number of frames to render
     int _numFrames;
@@ -223,12 +258,12 @@ private:
 
     // === METHODS ===
 
-    // finished current item rendering/transcoding
-    void finishCurrentItem(MediaUtils::RenderStatus lastStatus = MediaUtils::Finished );
-    // encodes the next item in the queue
+    // encodes the next items in the queue, as long as there are available slots
     void encodeNextItem();
-    // removes temp files, cache, restores AE templates...
-    void postRenderCleanUp( MediaUtils::RenderStatus lastStatus = MediaUtils::Finished );
+    // gets a slot which can encode the item, creating it if needed, or nullptr if the maximum number of jobs is reached
+    RenderSlot *availableSlot(QueueItem *item);
+    // sets the queue status from the status of the slots
+    void updateStatus();
 
 protected:
     /**
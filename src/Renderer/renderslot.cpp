@@ -0,0 +1,343 @@
+#include "Renderer/renderslot.h"
+
+RenderSlot::RenderSlot(int id, QObject *parent) : QObject(parent)
+{
+    _id = id;
+    _status = MediaUtils::Initializing;
+    _currentItem = nullptr;
+    _pipelining = false;
+    _pipelineStatus = MediaUtils::Finished;
+    _feeder = nullptr;
+    _aepFileName = "";
+
+    // === FFmpeg ===
+
+    _ffmpegRenderer = new FFmpegRenderer(this);
+    _ffmpegRenderer->setBinary( FFmpeg::instance()->binary() );
+    _ffmpegRenderer->setStopCommand("q\n");
+    connect( FFmpeg::instance(), &FFmpeg::binaryChanged, _ffmpegRenderer, &FFmpegRenderer::setBinary ) ;
+    connect( _ffmpegRenderer, &FFmpegRenderer::statusChanged, this, &RenderSlot::ffmpegStatusChanged ) ;
+    connect( _ffmpegRenderer, &FFmpegRenderer::progress, this, &RenderSlot::progress ) ;
+
+    // === After Effects ===
+
+    _aeRenderer = new AERenderer(this);
+    connect( _aeRenderer, &AERenderer::statusChanged, this, &RenderSlot::aeStatusChanged ) ;
+    connect( _aeRenderer, &AERenderer::progress, this, &RenderSlot::progress ) ;
+    connect( _aeRenderer, &AERenderer::progress, this, &RenderSlot::aeProgress ) ;
+
+    setStatus( MediaUtils::Waiting );
+}
+
+int RenderSlot::id() const
+{
+    return _id;
+}
+
+MediaUtils::RenderStatus RenderSlot::status() const
+{
+    return _status;
+}
+
+bool RenderSlot::isBusy() const
+{
+    return _currentItem != nullptr;
+}
+
+QueueItem *RenderSlot::currentItem() const
+{
+    return _currentItem;
+}
+
+AbstractRenderer *RenderSlot::activeRenderer() const
+{
+    if ( _status == MediaUtils::AERendering ) return _aeRenderer;
+    return _ffmpegRenderer;
+}
+
+FFmpegRenderer *RenderSlot::ffmpegRenderer() const
+{
+    return _ffmpegRenderer;
+}
+
+AERenderer *RenderSlot::aeRenderer() const
+{
+    return _aeRenderer;
+}
+
+void RenderSlot::render(QueueItem *item)
+{
+    if (isBusy() || item == nullptr) return;
+
+    _currentItem = item;
+    emit newLog("Slot " + QString::number(_id + 1) + " is taking a new item.", LogUtils::Debug);
+
+    launchItem();
+}
+
+void RenderSlot::stop(int timeout)
+{
+    if ( _pipelining )
+    {
+        _pipelineStatus = MediaUtils::Stopped;
+        if ( MediaUtils::isBusy( _aeRenderer->status() ) ) _aeRenderer->stop( timeout );
+        // ffmpeg stops when its input is closed
+        if ( _feeder != nullptr ) _feeder->stop();
+        _ffmpegRenderer->stop( timeout );
+    }
+    else if ( _status == MediaUtils::FFmpegEncoding )
+    {
+        _ffmpegRenderer->stop( timeout );
+    }
+    else if ( _status == MediaUtils::AERendering )
+    {
+        _aeRenderer->stop( timeout );
+    }
+}
+
+void RenderSlot::setStatus(MediaUtils::RenderStatus st)
+{
+    if( st == _status) return;
+    _status = st;
+    emit statusChanged(_status);
+}
+
+void RenderSlot::launchItem()
+{
+    setStatus( MediaUtils::Launching );
+
+    _pipelining = false;
+    _pipelineStatus = MediaUtils::Finished;
+    _ffmpegRenderer->setStopCommand("q\n");
+
+    //Check if there are AEP to render
+    if (_aeRenderer->render( _currentItem ) ) return;
+
+    //Now all aep are rendered, transcode with ffmpeg
+    _ffmpegRenderer->render( _currentItem );
+}
+
+void RenderSlot::postRenderCleanUp( MediaUtils::RenderStatus lastStatus )
+{
+    // Nothing to clean if we're not rendering (the renderers may still report their status after a stop)
+    if ( _currentItem == nullptr ) return;
+
+    //restore ae templates TODO run more tests for this
+    _aeRenderer->restoreTemplates();
+
+    setStatus( MediaUtils::Cleaning );
+
+    QueueItem *item = _currentItem;
+    _currentItem = nullptr;
+
+    if ( _pipelining )
+    {
+        // ffmpeg may have stopped before After Effects
+        if ( MediaUtils::isBusy( _aeRenderer->status() ) ) _aeRenderer->stop();
+        _pipelining = false;
+    }
+    if ( _feeder != nullptr )
+    {
+        _feeder->stop();
+        _feeder->deleteLater();
+        _feeder = nullptr;
+    }
+
+    item->setStatus( lastStatus );
+    item->postRenderCleanUp();
+
+    setStatus( MediaUtils::Waiting );
+
+    emit itemFinished( item, lastStatus );
+}
+
+void RenderSlot::ffmpegStatusChanged( MediaUtils::RenderStatus status )
+{
+    if ( _currentItem == nullptr ) return;
+
+    // The transcoding may be complete but not the After Effects render
+    if ( _pipelining && status == MediaUtils::Finished && _pipelineStatus != MediaUtils::Finished )
+    {
+        emit newLog("After Effects has not rendered all the frames, the transcoding is incomplete.", LogUtils::Warning );
+        postRenderCleanUp( _pipelineStatus );
+        return;
+    }
+
+    if ( MediaUtils::isBusy( status ) )
+    {
+        setStatus( MediaUtils::FFmpegEncoding );
+    }
+    else if ( status == MediaUtils::Finished )
+    {
+        emit newLog("FFmpeg Transcoding process finished.");
+        postRenderCleanUp( MediaUtils::Finished );
+    }
+    else if ( status == MediaUtils::Stopped )
+    {
+        emit newLog("FFmpeg transcoding has been stopped.");
+        postRenderCleanUp( MediaUtils::Stopped );
+    }
+    else if ( status == MediaUtils::Error )
+    {
+        emit newLog("An unexpected FFmpeg error has occured.", LogUtils::Critical );
+        postRenderCleanUp( MediaUtils::Error );
+    }
+}
+
+void RenderSlot::aeStatusChanged( MediaUtils::RenderStatus status )
+{
+    if ( _currentItem == nullptr ) return;
+
+    // ffmpeg is already transcoding, it takes care of the item
+    if ( _pipelining )
+    {
+        if ( status == MediaUtils::Finished )
+        {
+            emit newLog("After Effects Render process successfully finished");
+            removeTempAep();
+        }
+        else if ( status == MediaUtils::Stopped || status == MediaUtils::Error )
+        {
+            if (status == MediaUtils::Error) emit newLog("An unexpected After Effects error has occured.", LogUtils::Critical);
+            if (_pipelineStatus == MediaUtils::Finished) _pipelineStatus = status;
+            // Transcode what has been rendered
+            if ( _feeder != nullptr ) _feeder->stop();
+        }
+        return;
+    }
+
+    if ( MediaUtils::isBusy( status ) )
+    {
+        setStatus( MediaUtils::AERendering );
+    }
+    else if ( status == MediaUtils::Finished )
+    {
+        MediaInfo *input = _currentItem->getInputMedias()[0];
+
+        emit newLog("After Effects Render process successfully finished");
+
+        //encode rendered EXR
+        if (!input->aeUseRQueue())
+        {
+            //Remove Temp AEP
+            _aepFileName = input->fileName();
+            removeTempAep();
+
+            //set exr
+            //get one file
+            QString aeTempPath = input->cacheDir()->path();
+            QDir aeTempDir(aeTempPath);
+            QStringList filters("DuME_*.exr");
+            QStringList files = aeTempDir.entryList(filters,QDir::Files | QDir::NoDotAndDotDot);
+
+            //if nothing has been rendered, set to error and go on with next queue item
+            if (files.count() == 0)
+            {
+                postRenderCleanUp( MediaUtils::Error );
+                return;
+            }
+
+            //set file and launch
+            //frames
+            double frameRate = input->videoStreams()[0]->framerate();
+            //block signals: we don't want to change any output parameter connected to the input
+            QSignalBlocker b(input);
+            input->update( QFileInfo(aeTempPath + "/" + files[0]));
+            if (int( frameRate ) != 0) input->videoStreams()[0]->setFramerate(frameRate);
+            //add audio
+            QFileInfo audioFile(aeTempPath + "/DuME.wav");
+            if (audioFile.exists())
+            {
+                MediaInfo *audio = new MediaInfo(audioFile, _currentItem);
+                _currentItem->addInputMedia(audio);
+            }
+
+            //and go on with the transcoding
+            launchItem();
+        }
+        else
+        {
+            emit newLog("After Effects Rendering process successfully finished.");
+            postRenderCleanUp( MediaUtils::Finished );
+        }
+    }
+    else if ( status == MediaUtils::Stopped )
+    {
+        emit newLog("After Effects rendering has been stopped.");
+        postRenderCleanUp( MediaUtils::Stopped );
+    }
+    else if ( status == MediaUtils::Error )
+    {
+        emit newLog("An unexpected After Effects error has occured.", LogUtils::Critical);
+        postRenderCleanUp( MediaUtils::Error );
+    }
+}
+
+void RenderSlot::aeProgress()
+{
+    if ( _currentItem == nullptr || _pipelining || _status != MediaUtils::AERendering ) return;
+    if ( !canPipeline() ) return;
+
+    int startFrames = settings.value("aerender/pipelineFrames", 10).toInt();
+    if ( startFrames > _aeRenderer->numFrames() ) startFrames = _aeRenderer->numFrames();
+    if ( _aeRenderer->completedFrames() < startFrames ) return;
+
+    startPipeline();
+}
+
+bool RenderSlot::canPipeline()
+{
+    if ( !settings.value("aerender/pipeline", true).toBool() ) return false;
+
+    MediaInfo *input = _currentItem->getInputMedias()[0];
+    if ( !input->isAep() || input->aeUseRQueue() || input->cacheDir() == nullptr ) return false;
+    // The frames must be rendered in ranges to know which ones are complete
+    if ( _aeRenderer->numFrames() <= 0 || _aeRenderer->completedFrames() <= 0 ) return false;
+
+    // The audio is rendered at the end, wait for it
+    foreach( MediaInfo *output, _currentItem->getOutputMedias() )
+    {
+        if ( output->hasAudio() ) return false;
+    }
+
+    return true;
+}
+
+void RenderSlot::startPipeline()
+{
+    MediaInfo *input = _currentItem->getInputMedias()[0];
+    QString aeTempPath = input->cacheDir()->path();
+    QStringList files = QDir(aeTempPath).entryList(QStringList("DuME_*.exr"), QDir::Files, QDir::Name);
+    if ( files.count() == 0 ) return;
+
+    emit newLog("Transcoding the frames while After Effects is rendering.");
+
+    _aepFileName = input->fileName();
+
+    // Use the first frame to get the input settings
+    double frameRate = input->videoStreams()[0]->framerate();
+    QSignalBlocker b(input);
+    input->update( QFileInfo(aeTempPath + "/" + files[0]) );
+    if ( int( frameRate ) != 0 ) input->videoStreams()[0]->setFramerate(frameRate);
+
+    // ffmpeg reports the status of the item from now on
+    _pipelining = true;
+    _aeRenderer->detachJob();
+
+    // The input of ffmpeg is the frames, not commands
+    _ffmpegRenderer->setStopCommand("");
+    _ffmpegRenderer->setPipedInput( input, _aeRenderer->numFrames() );
+
+    _feeder = new FrameFeeder( _aeRenderer, _ffmpegRenderer, aeTempPath, "DuME_*.exr", this );
+    _ffmpegRenderer->render( _currentItem );
+    _feeder->start();
+}
+
+void RenderSlot::removeTempAep()
+{
+    if ( !settings.value("aerender/removeAep", true).toBool() ) return;
+
+    QFileInfo aep( _aepFileName );
+    QDir aepFolder = aep.dir();
+    if ( aepFolder.dirName() == "DuME aep" ) aepFolder.removeRecursively();
+}
@@ -0,0 +1,131 @@
+#ifndef RENDERSLOT_H
+#define RENDERSLOT_H
+
+#include <QObject>
+#include <QSettings>
+
+#include "FFmpeg/ffmpegrenderer.h"
+#include "AfterEffects/aerenderer.h"
+#include "AfterEffects/aftereffects.h"
+
+#include "queueitem.h"
+#include "framefeeder.h"
+
+/**
+ * @brief The RenderSlot class is a worker of the RenderQueue pool.
+ * It owns its own renderers (ffmpeg, After Effects...) and takes care of one QueueItem at a time,
+ * from the After Effects render to the final ffmpeg transcoding.
+ */
+class RenderSlot : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructs a new slot with its own renderers
+     * @param id The index of the slot in the pool, used in the logs
+     * @param parent The parent QObject
+     */
+    explicit RenderSlot(int id, QObject *parent = nullptr);
+
+    /**
+     * @brief The index of the slot in the pool
+     * @return
+     */
+    int id() const;
+    /**
+     * @brief The current status of the slot
+     * @return
+     */
+    MediaUtils::RenderStatus status() const;
+    /**
+     * @brief Checks if the slot is working on an item
+     * @return
+     */
+    bool isBusy() const;
+    /**
+     * @brief The item being rendered by this slot, or nullptr if the slot is available
+     * @return
+     */
+    QueueItem *currentItem() const;
+    /**
+     * @brief The renderer currently working for this slot
+     * @return The After Effects renderer while rendering an aep, the ffmpeg renderer otherwise
+     */
+    AbstractRenderer *activeRenderer() const;
+    FFmpegRenderer *ffmpegRenderer() const;
+    AERenderer *aeRenderer() const;
+
+    /**
+     * @brief Renders the item. The slot must be available.
+     * @param item The item to render
+     */
+    void render(QueueItem *item);
+    /**
+     * @brief Stops the current render
+     * @param timeout Kills the process after timeout if it does not respond. In milliseconds.
+     */
+    void stop(int timeout = 10000);
+
+signals:
+    /**
+     * @brief Emitted when the slot status changes.
+     */
+    void statusChanged( MediaUtils::RenderStatus );
+    /**
+     * @brief Emitted when some progression information is available
+     */
+    void progress();
+    /**
+     * @brief Emitted when the slot is done with its item (finished, stopped or in error) and is available again.
+     * @param item The item
+     * @param lastStatus The final status of the item
+     */
+    void itemFinished( QueueItem *item, MediaUtils::RenderStatus lastStatus );
+    /**
+     * @brief Emitted when some debug logs are available
+     */
+    void newLog( QString, LogUtils::LogType lt = LogUtils::Information );
+
+private slots:
+    void ffmpegStatusChanged(MediaUtils::RenderStatus status);
+    void aeStatusChanged(MediaUtils::RenderStatus status);
+    // Starts transcoding as soon as enough frames have been rendered by After Effects
+    void aeProgress();
+
+private:
+    // The index of the slot
+    int _id;
+    // The application settings
+    QSettings settings;
+    // The current status
+    MediaUtils::RenderStatus _status;
+    // The item being rendered
+    QueueItem *_currentItem;
+    // The renderers
+    FFmpegRenderer *_ffmpegRenderer;
+    AERenderer *_aeRenderer;
+
+    // Pipelined After Effects rendering: ffmpeg transcodes the frames while they're being rendered
+    bool _pipelining;
+    // The final status of the item when pipelining, if After Effects has not finished correctly
+    MediaUtils::RenderStatus _pipelineStatus;
+    // Sends the frames to ffmpeg
+    FrameFeeder *_feeder;
+    // The After Effects project, which may be temporary
+    QString _aepFileName;
+
+    // changes the current status (and emits statusChanged)
+    void setStatus(MediaUtils::RenderStatus st);
+    // launches the right renderer for the current item
+    void launchItem();
+    // checks if the current item can be transcoded while After Effects is rendering
+    bool canPipeline();
+    // starts transcoding while After Effects is rendering
+    void startPipeline();
+    // removes the project if it's a temporary copy made by DuME
+    void removeTempAep();
+    // removes temp files, restores AE templates, and releases the item
+    void postRenderCleanUp( MediaUtils::RenderStatus lastStatus = MediaUtils::Finished );
+};
+
+#endif // RENDERSLOT_H
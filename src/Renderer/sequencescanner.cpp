@@ -0,0 +1,265 @@
+#include "sequencescanner.h"
+
+// The maximum number of folders whose listing is kept
+#define MAX_LISTINGS 32
+// The minimum number of files per thread when reading the sizes
+#define MIN_FILES_PER_THREAD 256
+// The maximum length of a sequence, to list the missing frames
+#define MAX_FRAMES 10000000
+
+FrameSequence::FrameSequence()
+{
+    isValid = false;
+    numDigits = 0;
+    startNumber = 0;
+    endNumber = 0;
+    size = 0;
+}
+
+// Reads the sizes of a slice of the files
+class FileSizeTask : public QRunnable
+{
+public:
+    FileSizeTask(const QStringList *filePaths, QVector<qint64> *sizes, int from, int to)
+    {
+        _filePaths = filePaths;
+        _sizes = sizes;
+        _from = from;
+        _to = to;
+    }
+
+    void run()
+    {
+        // Each task writes to its own slice of the vector
+        for (int i = _from; i < _to; i++)
+        {
+            (*_sizes)[i] = QFileInfo( _filePaths->at(i) ).size();
+        }
+    }
+
+private:
+    const QStringList *_filePaths;
+    QVector<qint64> *_sizes;
+    int _from;
+    int _to;
+};
+
+SequenceScanner::SequenceScanner(QObject *parent) : QObject(parent)
+{
+
+}
+
+SequenceScanner *SequenceScanner::instance()
+{
+    if (!_instance) _instance = new SequenceScanner();
+    return _instance;
+}
+
+FrameSequence SequenceScanner::scan(QFileInfo frameFile, bool computeSizes)
+{
+    QString extension = frameFile.suffix();
+    QString baseName = frameFile.completeBaseName();
+    QString dirPath = frameFile.path();
+
+    QStringList names = fileNames(dirPath, extension);
+
+    FrameSequence sequence;
+    sequence.error = "This does not look like a sequence, we did not find the frame number.";
+
+    // Check each block of digits of the name
+    int i = 0;
+    while (i < baseName.count())
+    {
+        if (!baseName.at(i).isDigit())
+        {
+            i++;
+            continue;
+        }
+        int blockStart = i;
+        while (i < baseName.count() && baseName.at(i).isDigit()) i++;
+
+        QString left = baseName.left(blockStart);
+        QString right = baseName.mid(i);
+
+        sequence = scanBlock(names, dirPath, extension, left, right, computeSizes);
+        if (sequence.isValid) break;
+    }
+
+    return sequence;
+}
+
+QStringList SequenceScanner::fileNames(QString dirPath, QString extension)
+{
+    QString key = dirPath + "|" + extension;
+    QFileInfo dirInfo(dirPath);
+    QDateTime modified = dirInfo.lastModified();
+
+    // The listing is still valid if the folder has not been modified
+    if (_listings.contains(key))
+    {
+        DirListing listing = _listings.value(key);
+        if (listing.modified == modified) return listing.fileNames;
+        _listings.remove(key);
+    }
+
+    // Only the names are read, the file infos are not needed
+    QStringList names;
+    QDirIterator it(dirPath, QStringList("*." + extension), QDir::Files);
+    while (it.hasNext())
+    {
+        it.next();
+        names << it.fileName();
+    }
+
+    // The modification date may not be precise enough if the folder has just changed (file systems may use seconds)
+    if (modified.isValid() && modified.secsTo(QDateTime::currentDateTime()) > 2)
+    {
+        if (_listings.count() >= MAX_LISTINGS) _listings.clear();
+        DirListing listing;
+        listing.modified = modified;
+        listing.fileNames = names;
+        _listings.insert(key, listing);
+    }
+
+    return names;
+}
+
+QVector<qint64> SequenceScanner::fileSizes(const QStringList &filePaths)
+{
+    QVector<qint64> sizes(filePaths.count(), 0);
+
+    int numThreads = QThread::idealThreadCount();
+    if (numThreads < 1) numThreads = 1;
+    int slice = filePaths.count() / numThreads + 1;
+    if (slice < MIN_FILES_PER_THREAD) slice = MIN_FILES_PER_THREAD;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    for (int from = 0; from < filePaths.count(); from += slice)
+    {
+        int to = std::min(from + slice, int(filePaths.count()));
+        pool.start(new FileSizeTask(&filePaths, &sizes, from, to));
+    }
+    pool.waitForDone();
+
+    return sizes;
+}
+
+void SequenceScanner::clear()
+{
+    _listings.clear();
+}
+
+FrameSequence SequenceScanner::scanBlock(const QStringList &names, QString dirPath, QString extension, QString left, QString right, bool computeSizes)
+{
+    FrameSequence sequence;
+    sequence.left = left;
+    sequence.right = right;
+
+    // Get the frame numbers
+    QList<QPair<int, QString>> numberedNames;
+    bool numbersOk = true;
+    int startNumber = 999999999;
+    int endNumber = 0;
+    foreach(QString name, names)
+    {
+        int number = 0;
+        int numDigits = 0;
+        if (!frameNumber(name, left, right, extension, number, numDigits)) continue;
+
+        //check num digits
+        if (sequence.numDigits != 0 && sequence.numDigits != numDigits)
+        {
+            numbersOk = false;
+            qDebug() << "Wrong naming, missing leading zeroes";
+        }
+        sequence.numDigits = numDigits;
+
+        if (number < startNumber) startNumber = number;
+        if (number > endNumber) endNumber = number;
+        numberedNames << QPair<int, QString>(number, name);
+    }
+
+    if (startNumber == 999999999) startNumber = 0;
+    sequence.startNumber = startNumber;
+    sequence.endNumber = endNumber;
+
+    if (!numbersOk)
+    {
+        sequence.error = "Incorrect sequence file names.\nNumbers must have leading zeroes (\"8, 9, 10, 11\" has to be \"08, 09, 10, 11\").\n";
+        return sequence;
+    }
+
+    //Check if numbering is ok
+    if (endNumber == startNumber)
+    {
+        qDebug() << "Wrong digits block.";
+        sequence.error = "This does not look like a sequence, we did not find the frame number.";
+        return sequence;
+    }
+
+    std::sort(numberedNames.begin(), numberedNames.end());
+
+    QString dir = dirPath + "/";
+    for (int i = 0; i < numberedNames.count(); i++)
+    {
+        sequence.frames << dir + numberedNames.at(i).second;
+    }
+
+    //look for missing frames
+    int numFrames = endNumber - startNumber + 1;
+    if (numFrames != numberedNames.count())
+    {
+        sequence.error = "Some frames are missing.\n";
+        // Probably not a frame number
+        if (numFrames > MAX_FRAMES) return sequence;
+
+        QBitArray found(numFrames);
+        for (int i = 0; i < numberedNames.count(); i++)
+        {
+            found.setBit(numberedNames.at(i).first - startNumber);
+        }
+        for (int i = 0; i < numFrames; i++)
+        {
+            if (!found.testBit(i)) sequence.missingFrames << startNumber + i;
+        }
+        return sequence;
+    }
+
+    if (computeSizes)
+    {
+        QVector<qint64> sizes = fileSizes(sequence.frames);
+        for (int i = 0; i < sizes.count(); i++)
+        {
+            sequence.size += sizes.at(i);
+            if (sizes.at(i) < 10) sequence.emptyFrames << sequence.frames.at(i);
+        }
+    }
+
+    sequence.isValid = true;
+    sequence.error = "";
+    return sequence;
+}
+
+bool SequenceScanner::frameNumber(const QString &name, const QString &left, const QString &right, const QString &extension, int &number, int &numDigits)
+{
+    int suffixLength = right.count() + extension.count() + 1;
+    numDigits = name.count() - left.count() - suffixLength;
+    // Frame numbers must fit in an int
+    if (numDigits <= 0 || numDigits > 9) return false;
+    if (!name.startsWith(left)) return false;
+    if (name.at( name.count() - extension.count() - 1 ) != '.') return false;
+    if (!name.endsWith(extension, Qt::CaseInsensitive)) return false;
+    if (!name.midRef( left.count() + numDigits, right.count() ).startsWith(right)) return false;
+
+    number = 0;
+    for (int i = left.count(); i < left.count() + numDigits; i++)
+    {
+        QChar c = name.at(i);
+        if (c < '0' || c > '9') return false;
+        number = number * 10 + (c.unicode() - '0');
+    }
+    return true;
+}
+
+SequenceScanner *SequenceScanner::_instance = nullptr;
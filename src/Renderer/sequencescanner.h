@@ -0,0 +1,122 @@
+#ifndef SEQUENCESCANNER_H
+#define SEQUENCESCANNER_H
+
+#include <QObject>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QBitArray>
+#include <QThreadPool>
+#include <QThread>
+#include <QRunnable>
+#include <QtDebug>
+
+#include <algorithm>
+
+/**
+ * @brief The FrameSequence class is the result of the scan of a frame sequence
+ */
+class FrameSequence
+{
+public:
+    FrameSequence();
+
+    /**
+     * @brief True if a complete sequence has been found
+     */
+    bool isValid;
+    /**
+     * @brief Why the sequence is not valid
+     */
+    QString error;
+    /**
+     * @brief The parts of the file base name before and after the frame number
+     */
+    QString left;
+    QString right;
+    /**
+     * @brief The number of digits of the frame numbers
+     */
+    int numDigits;
+    int startNumber;
+    int endNumber;
+    /**
+     * @brief The paths of the frames, sorted by frame number
+     */
+    QStringList frames;
+    QList<int> missingFrames;
+    QStringList emptyFrames;
+    /**
+     * @brief The total size of the frames, in Bytes. 0 if the sizes have not been computed.
+     */
+    qint64 size;
+};
+
+/**
+ * @brief The SequenceScanner class finds the frames of image sequences.
+ * The folder is read only once per scan (without getting the file infos),
+ * and its listing is kept as long as the folder is not modified.
+ */
+class SequenceScanner : public QObject
+{
+    Q_OBJECT
+public:
+    static SequenceScanner *instance();
+
+    /**
+     * @brief Looks for the sequence a frame belongs to. Each block of digits of the file name is tested, the first complete sequence wins.
+     * @param frameFile Any frame of the sequence
+     * @param computeSizes Whether to get the size of the frames (to compute the bitrate and detect empty frames). The sizes are read in parallel.
+     * @return The sequence. If no complete sequence is found, the result of the last block tested.
+     */
+    FrameSequence scan(QFileInfo frameFile, bool computeSizes = true);
+    /**
+     * @brief Lists the files with the given extension in a folder
+     * @param dirPath The folder
+     * @param extension The extension, without the dot
+     * @return The file names
+     */
+    QStringList fileNames(QString dirPath, QString extension);
+    /**
+     * @brief Gets the sizes of the files, using several threads
+     * @param filePaths The files
+     * @return The sizes, in the same order
+     */
+    QVector<qint64> fileSizes(const QStringList &filePaths);
+    /**
+     * @brief Forgets all the folder listings
+     */
+    void clear();
+
+private:
+    //private constructor, this is a singleton
+    explicit SequenceScanner(QObject *parent = nullptr);
+
+    /**
+     * @brief Tests a block of digits of the file name
+     */
+    FrameSequence scanBlock(const QStringList &names, QString dirPath, QString extension, QString left, QString right, bool computeSizes);
+    /**
+     * @brief Gets the frame number of a file name, without regex
+     * @return false if the name does not match left + digits + right + "." + extension
+     */
+    static bool frameNumber(const QString &name, const QString &left, const QString &right, const QString &extension, int &number, int &numDigits);
+
+    /**
+     * @brief The listing of a folder
+     */
+    struct DirListing
+    {
+        QDateTime modified;
+        QStringList fileNames;
+    };
+    // The listings, by folder and extension
+    QHash<QString, DirListing> _listings;
+
+protected:
+    static SequenceScanner *_instance;
+};
+
+#endif // SEQUENCESCANNER_H
@@ -47,12 +47,16 @@ VideoInfo::VideoInfo(QObject *parent) : QObject(parent)
     _resizeAlgorithm = ffmpeg->resizeAlgorithm("");
     _isSequence = false;
     _startNumber = 0;
+    _numFrames = 0;
+    _rotation = 0;
 }
 
 VideoInfo::VideoInfo(QJsonObject obj, QObject *parent) : QObject(parent)
 {
     _language = nullptr;
     _id = -1;
+    _numFrames = 0;
+    _rotation = 0;
 
     //Don't send the changed signal when loading a json
     QSignalBlocker bThis(this);
@@ -151,6 +155,8 @@ void VideoInfo::copyFrom(VideoInfo *other, bool silent)
     _resizeAlgorithm = other->resizeAlgorithm();
     _isSequence = other->isSequence();
     _startNumber = other->startNumber();
+    _numFrames = other->numFrames();
+    _rotation = other->rotation();
 
     if(!silent) emit changed();
 }
@@ -920,6 +926,28 @@ void VideoInfo::setStartNumber(int startNumber, bool silent)
     if(!silent) emit changed();
 }
 
+int VideoInfo::numFrames() const
+{
+    return _numFrames;
+}
+
+void VideoInfo::setNumFrames(int numFrames, bool silent)
+{
+    _numFrames = numFrames;
+    if(!silent) emit changed();
+}
+
+int VideoInfo::rotation() const
+{
+    return _rotation;
+}
+
+void VideoInfo::setRotation(int rotation, bool silent)
+{
+    _rotation = rotation;
+    if(!silent) emit changed();
+}
+
 FFColorProfile *VideoInfo::workingSpace() const
 {
     return _workingSpace;
@@ -185,6 +185,20 @@ public:
     int startNumber() const;
     void setStartNumber(int startNumber, bool silent = false);
 
+    /**
+     * @brief The exact number of frames of the stream, as reported by the prober
+     * @return 0 if unknown
+     */
+    int numFrames() const;
+    void setNumFrames(int numFrames, bool silent = false);
+
+    /**
+     * @brief The rotation of the frames set in the metadata (rotate tag or display matrix), in degrees.
+     * ffmpeg rotates the frames before filtering them, so with ±90°, the filters get frames of height × width.
+     */
+    int rotation() const;
+    void setRotation(int rotation, bool silent = false);
+
 signals:
     void changed();
 
@@ -265,6 +279,8 @@ private:
     bool _sceneDetection;
     bool _isSequence;
     int _startNumber;
+    int _numFrames;
+    int _rotation;
 };
 
 #endif // VIDEOINFO_H
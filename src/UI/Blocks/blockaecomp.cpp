@@ -16,12 +16,14 @@ void BlockAEComp::activate(bool activate)
         else _mediaInfo->setAepCompName( "" );
         if ( rqindexButton->isChecked() ) _mediaInfo->setAepRqindex( rqindexBox->value() );
         else _mediaInfo->setAepRqindex( -1 );
+        _mediaInfo->setAepStartFrame( startFrameBox->value() );
     }
     else
     {
         _mediaInfo->setAeUseRQueue( true );
         _mediaInfo->setAepCompName( "" );
         _mediaInfo->setAepRqindex( -1 );
+        _mediaInfo->setAepStartFrame( -1 );
     }
 
     _freezeUI = false;
@@ -31,6 +33,8 @@ void BlockAEComp::update()
 {
     _freezeUI = true;
 
+    startFrameBox->setValue( _mediaInfo->aepStartFrame() );
+
     if (_mediaInfo->aeUseRQueue())
     {
         aeRenderQueueButton->setChecked( true );
@@ -106,3 +110,9 @@ void BlockAEComp::on_rqindexBox_valueChanged(int arg1)
     if ( _freezeUI ) return;
     _mediaInfo->setAepRqindex( arg1 );
 }
+
+void BlockAEComp::on_startFrameBox_valueChanged(int arg1)
+{
+    if ( _freezeUI ) return;
+    _mediaInfo->setAepStartFrame( arg1 );
+}
@@ -19,6 +19,7 @@ private slots:
     void on_aeRenderQueueButton_clicked(bool checked);
     void on_compEdit_editingFinished();
     void on_rqindexBox_valueChanged(int arg1);
+    void on_startFrameBox_valueChanged(int arg1);
 };
 
 #endif // BLOCKAECOMP_H
@@ -12,6 +12,9 @@ CacheSettingsWidget::CacheSettingsWidget(QWidget *parent) :
     QString cachePath = QDir::toNativeSeparators( CacheManager::instance()->getRootCacheDir().absolutePath() );
     cacheEdit->setText(cachePath);
 
+    //Max size
+    maxSizeBox->setValue( int( CacheManager::instance()->maxCacheSize() / 1073741824 ) );
+
     _freezeUI = false;
 }
 
@@ -43,3 +46,9 @@ void CacheSettingsWidget::on_openButton_clicked()
 {
     FileUtils::openInExplorer(CacheManager::instance()->getRootCacheDir().absolutePath());
 }
+
+void CacheSettingsWidget::on_maxSizeBox_valueChanged(int arg1)
+{
+    if (_freezeUI) return;
+    CacheManager::instance()->setMaxCacheSize( qint64(arg1) * 1073741824 );
+}
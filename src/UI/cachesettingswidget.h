@@ -24,6 +24,8 @@ private slots:
 
     void on_openButton_clicked();
 
+    void on_maxSizeBox_valueChanged(int arg1);
+
 private:
     QSettings settings;
     bool _freezeUI;
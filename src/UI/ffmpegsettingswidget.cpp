@@ -12,6 +12,11 @@ FFmpegSettingsWidget::FFmpegSettingsWidget(QWidget *parent) :
 
     ffmpegPathEdit->setText( QDir::toNativeSeparators( FFmpeg::instance()->binary() ) );
     userPresetsPathEdit->setText(_settings.value("presets/path","").toString());
+    maxJobsBox->setValue( RenderQueue::instance()->maxConcurrentJobs() );
+    segmentsBox->setChecked( _settings.value("ffmpeg/segmentEncoding", false).toBool() );
+    ffprobeBox->setChecked( _settings.value("ffmpeg/useFFprobe", true).toBool() );
+    optimizeFiltersBox->setChecked( _settings.value("ffmpeg/optimizeFilters", true).toBool() );
+    showFilterGraphBox->setChecked( _settings.value("ffmpeg/showFilterGraph", false).toBool() );
 
     connect( FFmpeg::instance(), SIGNAL( statusChanged(MediaUtils::RenderStatus)), this, SLOT ( ffmpegStatus(MediaUtils::RenderStatus)) );
 
@@ -68,3 +73,33 @@ void FFmpegSettingsWidget::on_openButton_clicked()
 {
     FileUtils::openInExplorer(PresetManager::instance()->userPresetsPath());
 }
+
+void FFmpegSettingsWidget::on_maxJobsBox_valueChanged(int arg1)
+{
+    if (_freezeUI) return;
+    RenderQueue::instance()->setMaxConcurrentJobs( arg1 );
+}
+
+void FFmpegSettingsWidget::on_segmentsBox_clicked(bool checked)
+{
+    _settings.setValue("ffmpeg/segmentEncoding", checked);
+    _settings.sync();
+}
+
+void FFmpegSettingsWidget::on_ffprobeBox_clicked(bool checked)
+{
+    _settings.setValue("ffmpeg/useFFprobe", checked);
+    _settings.sync();
+}
+
+void FFmpegSettingsWidget::on_optimizeFiltersBox_clicked(bool checked)
+{
+    _settings.setValue("ffmpeg/optimizeFilters", checked);
+    _settings.sync();
+}
+
+void FFmpegSettingsWidget::on_showFilterGraphBox_clicked(bool checked)
+{
+    _settings.setValue("ffmpeg/showFilterGraph", checked);
+    _settings.sync();
+}
@@ -9,6 +9,7 @@
 #include "duqf-utils/utils.h"
 #include "FFmpeg/ffmpeg.h"
 #include "Renderer/presetmanager.h"
+#include "Renderer/renderqueue.h"
 
 class FFmpegSettingsWidget : public QWidget, private Ui::FFmpegSettingsWidget
 {
@@ -27,6 +28,11 @@ private slots:
     void on_userPresetsPathEdit_editingFinished();
     void ffmpegStatus(MediaUtils::RenderStatus status);
     void on_openButton_clicked();
+    void on_maxJobsBox_valueChanged(int arg1);
+    void on_segmentsBox_clicked(bool checked);
+    void on_ffprobeBox_clicked(bool checked);
+    void on_optimizeFiltersBox_clicked(bool checked);
+    void on_showFilterGraphBox_clicked(bool checked);
 
 private:
     QSettings _settings;
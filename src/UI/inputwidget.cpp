@@ -53,14 +53,15 @@ MediaInfo *InputWidget::mediaInfo()
     return _mediaInfo;
 }
 
-void InputWidget::openFile(QString file)
+void InputWidget::openFile(QString file, bool async)
 {
     QSettings settings;
     if (file == "") return;
     file = QDir::toNativeSeparators( file );
 
     QFileInfo fileInfo(file);
-    _mediaInfo->update( fileInfo );
+    if (async) _mediaInfo->updateAsync( fileInfo );
+    else _mediaInfo->update( fileInfo );
 
     //keep in settings
     settings.setValue("input/path", fileInfo.path() );
@@ -70,9 +71,9 @@ void InputWidget::openFile(QString file)
     updateOptions();
 }
 
-void InputWidget::openFile(QUrl file)
+void InputWidget::openFile(QUrl file, bool async)
 {
-    openFile(file.toLocalFile());
+    openFile(file.toLocalFile(), async);
 }
 
 bool InputWidget::hasMedia()
@@ -167,8 +168,12 @@ void InputWidget::updateOptions()
 
 void InputWidget::updateInfo()
 {
+    // The name may change after the analysis (frame sequences)
+    if (_mediaInfo->fileName() != "") inputEdit->setText( _mediaInfo->fileName() );
+
     QString mediaInfoString = "Media information\n\n";
-    mediaInfoString += _mediaInfo->getDescription();
+    if (_mediaInfo->isProbing()) mediaInfoString += "Analysing media...";
+    else mediaInfoString += _mediaInfo->getDescription();
 
     mediaInfosText->setText(mediaInfoString);
 }
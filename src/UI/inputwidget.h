@@ -31,8 +31,13 @@ public:
      * @return The current MediaInfo
      */
     MediaInfo *mediaInfo();
-    void openFile(QString file);
-    void openFile(QUrl file);
+    /**
+     * @brief Opens a media file
+     * @param file The file
+     * @param async When true, the media is analysed in the background and the widget is updated once the analysis is available
+     */
+    void openFile(QString file, bool async = true);
+    void openFile(QUrl file, bool async = true);
     bool hasMedia();
 
 private slots:
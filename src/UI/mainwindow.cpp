@@ -126,7 +126,7 @@ MainWindow::MainWindow(QStringList args, QWidget *parent) :
     _cacheButton->setMinimumWidth(100);
     connect(_cacheButton, &QToolButton::clicked, this, &MainWindow::openCacheDir);
     connect(CacheManager::instance(), &CacheManager::cacheSizeChanged, this, &MainWindow::cacheSizeChanged);
-    CacheManager::instance()->scan();
+    cacheSizeChanged( CacheManager::instance()->cacheSize() );
 
     log("Init - Setting default UI items", LogUtils::Debug);
 
@@ -171,10 +171,13 @@ MainWindow::MainWindow(QStringList args, QWidget *parent) :
     connect(renderQueue, SIGNAL( newLog( QString, LogUtils::LogType )), this, SLOT( log( QString, LogUtils::LogType )) );
     connect(renderQueue, SIGNAL( progress( )), this, SLOT( progress( )) );
 
-    connect(FFmpegRenderer::instance(), &AbstractRenderer::console, this, &MainWindow::ffmpegConsole );
-    connect(FFmpegRenderer::instance(), &AbstractRenderer::newLog, this, &MainWindow::ffmpegLog );
-    connect(AERenderer::instance(), &AbstractRenderer::console, this, &MainWindow::aeConsole );
-    connect(AERenderer::instance(), &AbstractRenderer::newLog, this, &MainWindow::aeLog );
+    connect(renderQueue, &RenderQueue::ffmpegConsole, this, &MainWindow::ffmpegConsole );
+    connect(renderQueue, &RenderQueue::ffmpegLog, this, &MainWindow::ffmpegLog );
+    connect(renderQueue, &RenderQueue::aeConsole, this, &MainWindow::aeConsole );
+    connect(renderQueue, &RenderQueue::aeLog, this, &MainWindow::aeLog );
+
+    // === MEDIA ANALYSIS ===
+    connect(ProbeService::instance(), &ProbeService::pendingProbesChanged, this, &MainWindow::pendingProbesChanged );
 
     // final connections
 
@@ -185,6 +188,7 @@ MainWindow::MainWindow(QStringList args, QWidget *parent) :
 
     //parse arguments if ffmpeg is valid
     autoQuit = false;
+    goPending = false;
 
     if (FFmpeg::instance()->isValid())
     {
@@ -260,7 +264,7 @@ MainWindow::MainWindow(QStringList args, QWidget *parent) :
                         settings.setValue("aerender/path", args[i]);
                         settings.sync();
                         AfterEffects::instance()->setBinary("Custom");
-                        AERenderer::instance()->setUseTemplates(false);
+                        AERenderer::setUseTemplates(false);
                     }
 #endif
                     else if (arg != "--no-banner" && arg != "--hide-console")
@@ -637,6 +641,10 @@ void MainWindow::progress()
         }
     }
 
+    //several items are being encoded at once
+    int numItems = renderQueue->currentItems().count();
+    if (numItems > 1) filename = QString::number( numItems ) + " items";
+
     currentEncodingNameLabel->setText( filename );
 
     progressBar->setMaximum( numFrames );
@@ -715,6 +723,18 @@ void MainWindow::progress()
 
 }
 
+void MainWindow::pendingProbesChanged(int pendingProbes)
+{
+    if (pendingProbes > 0)
+    {
+        mainStatusBar->showMessage( "Analysing " + QString::number(pendingProbes) + " media..." );
+        return;
+    }
+
+    mainStatusBar->clearMessage();
+    if (goPending) go();
+}
+
 void MainWindow::renderQueueStatusChanged(MediaUtils::RenderStatus status)
 {
     QString stText = MediaUtils::statusString( status );
@@ -867,6 +887,18 @@ void MainWindow::on_aeCommandsButton_clicked()
 
 void MainWindow::go()
 {
+    //Wait for the inputs to be analysed
+    foreach(MediaInfo *input, queueWidget->getInputMedia())
+    {
+        if (input->isProbing())
+        {
+            log("Waiting for the media analysis before encoding...");
+            goPending = true;
+            return;
+        }
+    }
+    goPending = false;
+
     //Launch!
     log("=== Beginning encoding ===");
     renderQueue->encode( queueWidget->job() );
@@ -973,13 +1005,16 @@ void MainWindow::dropEvent(QDropEvent *event)
     if (mimeData->hasUrls())
     {
         QList<QUrl> urlList = mimeData->urls();
-        if (urlList.count() == 1)
+        bool first = true;
+        foreach(QUrl url, urlList)
         {
-            QString f = urlList[0].toLocalFile();
-            if (QFile(f).exists())
-            {
-                queueWidget->openInputFile(f);
-            }
+            QString f = url.toLocalFile();
+            if (!QFile(f).exists()) continue;
+            //the first file replaces the current input, the others are added as new inputs
+            //they're all analysed in parallel in the background
+            if (first) queueWidget->openInputFile(f);
+            else queueWidget->addInputFile(f, true);
+            first = false;
         }
 
     }
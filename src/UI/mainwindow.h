@@ -25,6 +25,7 @@
 
 #include "AfterEffects/aftereffects.h"
 #include "Renderer/renderqueue.h"
+#include "Renderer/probeservice.h"
 #include "Renderer/presetmanager.h"
 #include "lutbakerwidget.h"
 #include "lutconverterwidget.h"
@@ -68,6 +69,7 @@ private slots:
     // Queue
     void progress();
     void renderQueueStatusChanged(MediaUtils::RenderStatus status);
+    void pendingProbesChanged(int pendingProbes);
 
     // Queue Item (to be moved in a new RenderQueueWidget class
     void queueItemStatusChanged(MediaUtils::RenderStatus status);
@@ -164,6 +166,8 @@ private:
      */
     RenderQueue *renderQueue;
     bool autoQuit;
+    // true when the queue has to be launched as soon as the inputs are analysed
+    bool goPending;
 
 protected:
     void closeEvent(QCloseEvent *event);
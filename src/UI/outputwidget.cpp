@@ -15,6 +15,7 @@ OutputWidget::OutputWidget(int id, MediaList *inputMedias, QWidget *parent) :
 
     // FFmpeg
     connect( FFmpeg::instance(),SIGNAL(binaryChanged(QString)),this,SLOT(ffmpeg_init()) );
+    connect( FFmpeg::instance(),SIGNAL(muxersLoaded()),this,SLOT(ffmpeg_muxersLoaded()) );
     // Keep the id
     _index = id;
     // Associated MediaInfo
@@ -139,6 +140,13 @@ void OutputWidget::ffmpeg_loadMuxers()
     _freezeUI = frozen;
 }
 
+void OutputWidget::ffmpeg_muxersLoaded()
+{
+    // The extensions and default codecs are now known
+    ffmpeg_loadMuxers();
+    mediaInfoChanged();
+}
+
 MediaInfo *OutputWidget::mediaInfo()
 {
     return _mediaInfo;
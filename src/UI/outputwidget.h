@@ -64,6 +64,7 @@ public slots:
     void openPresetFile(QString filename);
 
 private slots:
+    void ffmpeg_muxersLoaded();
     void mediaInfoChanged();
     void newInputMedia(MediaInfo* m);
     void inputChanged();
@@ -84,11 +84,11 @@ void QueueWidget::openInputFile(QUrl file)
     inputWidgets[ inputTab->currentIndex() ]->openFile(file);
 }
 
-MediaInfo *QueueWidget::addInputFile(QString file)
+MediaInfo *QueueWidget::addInputFile(QString file, bool async)
 {
     addInput();
     InputWidget *iw = inputWidgets[ inputTab->currentIndex() ];
-    iw->openFile(file);
+    iw->openFile(file, async);
     return iw->mediaInfo();
 }
 
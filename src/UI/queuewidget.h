@@ -27,7 +27,13 @@ public:
     MediaList *outputMedias();
     void openInputFile(QString file);
     void openInputFile(QUrl file);
-    MediaInfo *addInputFile(QString file);
+    /**
+     * @brief Adds a new input and opens the file
+     * @param file The file
+     * @param async When true, the media is analysed in the background
+     * @return The new input media
+     */
+    MediaInfo *addInputFile(QString file, bool async = false);
 
 signals:
     /**
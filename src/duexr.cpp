@@ -1,71 +1,425 @@
 #include "duexr.h"
+
+#ifdef WITH_OIIO
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo.h>
+#include <vector>
 using namespace OIIO;
+#endif
 
-#include <QtDebug>
+// Milliseconds between two checks of the target input buffer
+#define FEED_INTERVAL 20
+// The maximum amount of data waiting to be read by the target, in Bytes
+#define MAX_BUFFER_SIZE 67108864
+// The maximum amount of decoded frames waiting to be sent, in Bytes
+#define MAX_QUEUE_SIZE 1073741824
 
-DuEXR::DuEXR(QObject *parent) : QObject(parent)
+DuEXR::DuEXR(QStringList frames, QObject *parent) : QObject(parent)
 {
-    //test
-/*
-    auto in = ImageInput::open ("/home/duduf/DEV_SRC/DuFFMpeg/Test Medias/EXR (from Ae)/MYT_0046.003_00000.exr");
-    if (! in)
-        return;
+    _frames = frames;
+    _width = 0;
+    _height = 0;
+    _alpha = false;
+    _target = nullptr;
+    _maxQueued = 2;
+    _nextFrame = 0;
+    _fedFrames = 0;
+    _transcoding = false;
+    _transcodedFrames = 0;
+
+    QSettings settings;
+    int numThreads = settings.value("exr/decodeThreads", 0).toInt();
+    if (numThreads <= 0) numThreads = QThread::idealThreadCount();
+    _pool = new QThreadPool(this);
+    _pool->setMaxThreadCount( numThreads );
+
+    _timer = new QTimer(this);
+    _timer->setInterval(FEED_INTERVAL);
+    connect(_timer, SIGNAL(timeout()), this, SLOT(feed()));
+}
+
+DuEXR::~DuEXR()
+{
+    // The tasks write to this object
+    _pool->clear();
+    _pool->waitForDone();
+}
+
+bool DuEXR::isAvailable()
+{
+#ifdef WITH_OIIO
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool DuEXR::readSpec()
+{
+    if (_frames.count() == 0) return false;
+#ifdef WITH_OIIO
+    auto in = ImageInput::open( _frames.at(0).toStdString() );
+    if (!in)
+    {
+        qWarning().noquote() << "Cannot read the EXR frame " + _frames.at(0);
+        return false;
+    }
     const ImageSpec &spec = in->spec();
-    //get compression data
-#ifdef QT_DEBUG
-    qDebug() << QString::fromStdString( spec.decode_compression_metadata().first.str() );
-    qDebug() << spec.decode_compression_metadata().second;
+    bool rgb = spec.channelindex("R") >= 0 && spec.channelindex("G") >= 0 && spec.channelindex("B") >= 0;
+    // The display window, the data window may be smaller
+    _width = spec.full_width;
+    _height = spec.full_height;
+    _alpha = spec.channelindex("A") >= 0;
+    in->close();
+    return rgb && _width > 0 && _height > 0;
+#else
+    return false;
 #endif
-    int xres = spec.width;
-    int yres = spec.height;
-    int channels = spec.nchannels;
-    float *pixels = new float [xres * yres * channels];
-    in->read_image (TypeDesc::FLOAT, pixels);
-    in->close ();
+}
+
+int DuEXR::width() const
+{
+    return _width;
+}
+
+int DuEXR::height() const
+{
+    return _height;
+}
+
+bool DuEXR::hasAlpha() const
+{
+    return _alpha;
+}
+
+QString DuEXR::pixFormat() const
+{
+    if (_alpha) return "gbrapf32le";
+    return "gbrpf32le";
+}
+
+qint64 DuEXR::frameSize() const
+{
+    int numPlanes = _alpha ? 4 : 3;
+    return qint64(_width) * _height * numPlanes * qint64(sizeof(float));
+}
+
+void DuEXR::start(AbstractRenderer *target)
+{
+    // Forget the frames of the previous run
+    _pool->clear();
+    _pool->waitForDone();
+    _decodedFrames.clear();
+
+    _target = target;
+    _nextFrame = 0;
+    _fedFrames = 0;
+
+    // Keep all the threads busy, without filling the memory with large frames
+    _maxQueued = _pool->maxThreadCount() * 2;
+    qint64 maxFrames = MAX_QUEUE_SIZE / qMax(frameSize(), qint64(1));
+    if (_maxQueued > maxFrames) _maxQueued = int(maxFrames);
+    if (_maxQueued < 2) _maxQueued = 2;
+
+    _timer->start();
+    feed();
+}
+
+void DuEXR::stop()
+{
+    if (_transcoding)
+    {
+        // The frames being converted are finished, not the others
+        _transcoding = false;
+        _pool->clear();
+        return;
+    }
+
+    if (!_timer->isActive()) return;
+    _timer->stop();
+    _pool->clear();
+    if (_target != nullptr) _target->closeInput();
+}
 
-    const char *filename = "/home/duduf/DEV_SRC/DuFFMpeg/Test Medias/EXR (from Ae)/MYT_0046.003_00000b.exr";
+int DuEXR::numFedFrames() const
+{
+    return _fedFrames;
+}
+
+void DuEXR::transcode(QString outputFileName, int startNumber, OutputSettings settings)
+{
+    _pool->clear();
+    _pool->waitForDone();
+    _transcodedFrames = 0;
+    _failedFrames.clear();
+    _transcoding = true;
 
-    std::unique_ptr<ImageOutput> out = ImageOutput::create (filename);
-    if (! out)
+    if (_frames.count() == 0)
+    {
+        _transcoding = false;
+        emit finished();
         return;
-    ImageSpec outSpec (xres, yres, channels, TypeDesc::FLOAT);
-    outSpec.attribute("compression","none");
-    out->open (filename, spec);
-    out->write_image (TypeDesc::FLOAT, pixels);
-    out->close ();
-*/
-
-    //test copy image
-    // Open the input file
-    const char *input = "/home/duduf/DEV_SRC/DuFFMpeg/Test Medias/EXR (from Ae)/MYT_0046.003_00001.exr";
-    std::unique_ptr<ImageInput> cin = ImageInput::open (input);
-
-    // Make an output spec, identical to the input except for metadata
-    ImageSpec out_spec = cin->spec();
-
-#ifdef QT_DEBUG
-    qDebug() << "input compression";
-    qDebug() << QString::fromStdString( out_spec.decode_compression_metadata().first.str() );
-    qDebug() << out_spec.decode_compression_metadata().second;
+    }
+
+    // Each frame is independent, the pool runs as many as it can
+    for (int i = 0; i < _frames.count(); i++)
+    {
+        QString output = frameFileName( outputFileName, startNumber + i );
+        _pool->start( new TranscodeTask(this, i, output, settings) );
+    }
+}
+
+QStringList DuEXR::failedFrames() const
+{
+    return _failedFrames;
+}
+
+bool DuEXR::isSupported(QString extension)
+{
+    QStringList extensions;
+    extensions << "exr" << "png" << "dpx" << "tif" << "tiff" << "jpg" << "jpeg" << "tga" << "bmp";
+    return extensions.contains( extension.toLower() );
+}
+
+void DuEXR::feed()
+{
+    if (!_timer->isActive()) return;
+
+    // The target has been stopped
+    MediaUtils::RenderStatus status = _target->status();
+    if (!MediaUtils::isBusy( status ) || status == MediaUtils::Cleaning)
+    {
+        stop();
+        emit finished();
+        return;
+    }
+
+    while (_fedFrames < _frames.count())
+    {
+        // Don't fill the memory if the target is slower
+        if (_target->inputBufferSize() > MAX_BUFFER_SIZE) break;
+
+        bool ready = false;
+        QByteArray frame = takeFrame(_fedFrames, ready);
+        if (!ready) break;
+
+        // Keep the timing if a frame is broken
+        if (frame.isEmpty())
+        {
+            qWarning().noquote() << "Cannot decode the EXR frame " + _frames.at(_fedFrames);
+            frame = QByteArray( int(frameSize()), 0 );
+        }
+
+        if (!_target->writeInput( frame ))
+        {
+            // The target has stopped
+            stop();
+            emit finished();
+            return;
+        }
+        _fedFrames++;
+    }
+
+    decodeNext();
+
+    if (_fedFrames >= _frames.count())
+    {
+        stop();
+        emit finished();
+    }
+}
+
+QByteArray DuEXR::decode(QString fileName, int width, int height, bool alpha)
+{
+    QByteArray frame;
+#ifdef WITH_OIIO
+    auto in = ImageInput::open( fileName.toStdString() );
+    if (!in) return frame;
+    const ImageSpec &spec = in->spec();
+
+    int channels[4];
+    channels[0] = spec.channelindex("R");
+    channels[1] = spec.channelindex("G");
+    channels[2] = spec.channelindex("B");
+    channels[3] = spec.channelindex("A");
+    if (channels[0] < 0 || channels[1] < 0 || channels[2] < 0)
+    {
+        in->close();
+        return frame;
+    }
+
+    // The EXR channels are sorted by name, read them all and pick RGBA
+    std::vector<float> pixels( size_t(spec.width) * size_t(spec.height) * size_t(spec.nchannels) );
+    bool ok = in->read_image( TypeDesc::FLOAT, pixels.data() );
+    int dataX = spec.x - spec.full_x;
+    int dataY = spec.y - spec.full_y;
+    int dataWidth = spec.width;
+    int dataHeight = spec.height;
+    int numChannels = spec.nchannels;
+    in->close();
+    if (!ok) return frame;
+
+    int numPlanes = alpha ? 4 : 3;
+    qint64 planeSize = qint64(width) * height;
+    frame = QByteArray( int(planeSize * numPlanes * qint64(sizeof(float))), 0 );
+    float *planes = reinterpret_cast<float *>( frame.data() );
+    // The ffmpeg planes are in the G, B, R, A order
+    const int order[4] = { 1, 2, 0, 3 };
+
+    // Pixels outside of the data window stay transparent black
+    for (int y = 0; y < dataHeight; y++)
+    {
+        int frameY = dataY + y;
+        if (frameY < 0 || frameY >= height) continue;
+        const float *row = pixels.data() + size_t(y) * size_t(dataWidth) * size_t(numChannels);
+        for (int x = 0; x < dataWidth; x++)
+        {
+            int frameX = dataX + x;
+            if (frameX < 0 || frameX >= width) continue;
+            const float *pixel = row + size_t(x) * size_t(numChannels);
+            qint64 index = qint64(frameY) * width + frameX;
+            for (int p = 0; p < numPlanes; p++)
+            {
+                int c = channels[ order[p] ];
+                planes[p * planeSize + index] = c >= 0 ? pixel[c] : 1.0f;
+            }
+        }
+    }
+#else
+    Q_UNUSED(fileName)
+    Q_UNUSED(width)
+    Q_UNUSED(height)
+    Q_UNUSED(alpha)
 #endif
+    return frame;
+}
+
+bool DuEXR::convert(QString inputFileName, QString outputFileName, OutputSettings settings)
+{
+#ifdef WITH_OIIO
+    ImageBuf source( inputFileName.toStdString() );
+    if (!source.read()) return false;
+    const ImageSpec &sourceSpec = source.spec();
 
-    out_spec.attribute("compression","none");
+    // Pick the channels, a missing alpha is opaque
+    std::vector<int> order;
+    std::vector<float> values;
+    std::vector<std::string> names;
+    foreach(QString channel, settings.channels)
+    {
+        int index = sourceSpec.channelindex( channel.toStdString() );
+        if (index < 0 && channel != "A") return false;
+        order.push_back( index );
+        values.push_back( 1.0f );
+        names.push_back( channel.toStdString() );
+    }
 
-#ifdef QT_DEBUG
-    qDebug() << "output compression";
-    qDebug() << QString::fromStdString( out_spec.decode_compression_metadata().first.str() );
-    qDebug() << out_spec.decode_compression_metadata().second;
+    ImageBuf frame;
+    // The frames are already processed in parallel
+    if (!ImageBufAlgo::channels(frame, source, int(order.size()), order, values, names, false, 1)) return false;
+
+    ImageSpec &spec = frame.specmod();
+    if (settings.compression != "") spec.attribute( "compression", settings.compression.toStdString() );
+    if (settings.bitsPerSample > 0) spec.attribute( "oiio:BitsPerSample", settings.bitsPerSample );
+
+    TypeDesc format = TypeDesc::UNKNOWN;
+    if (settings.format != "") format = TypeDesc( settings.format.toStdString() );
+    return frame.write( outputFileName.toStdString(), format );
+#else
+    Q_UNUSED(inputFileName)
+    Q_UNUSED(outputFileName)
+    Q_UNUSED(settings)
+    return false;
 #endif
+}
 
-    // Create the output file and copy the image
-    const char *output = "/home/duduf/DEV_SRC/DuFFMpeg/Test Medias/EXR (from Ae)/MYT_0046.003_00001b.exr";
-    std::unique_ptr<ImageOutput> cout = ImageOutput::create (output);
-    cout->open (output, out_spec);
-    cout->copy_image (cin.get());
+QString DuEXR::frameFileName(QString sequenceName, int number)
+{
+    // The naming of MediaInfo::loadSequence()
+    QRegularExpression regExDigits("{(#+)}");
+    QRegularExpressionMatch match = regExDigits.match(sequenceName);
+    while (match.hasMatch())
+    {
+        int numDigits = match.capturedLength(1);
+        sequenceName.replace(match.capturedStart(), match.capturedLength(), QString("%1").arg(number, numDigits, 10, QChar('0')));
+        match = regExDigits.match(sequenceName);
+    }
+    return sequenceName;
+}
 
-    // Clean up
-    cout->close ();
-    cin->close ();
+void DuEXR::addFrame(int index, QByteArray frame)
+{
+    QMutexLocker locker(&_mutex);
+    _decodedFrames.insert(index, frame);
+    locker.unlock();
+    // Send it from the main thread
+    QMetaObject::invokeMethod(this, "feed", Qt::QueuedConnection);
+}
+
+QByteArray DuEXR::takeFrame(int index, bool &ready)
+{
+    QMutexLocker locker(&_mutex);
+    ready = _decodedFrames.contains(index);
+    return _decodedFrames.take(index);
+}
 
+void DuEXR::frameDone(int index, bool ok)
+{
+    if (!_transcoding) return;
+
+    if (!ok)
+    {
+        qWarning().noquote() << "Cannot convert the frame " + _frames.at(index);
+        _failedFrames << _frames.at(index);
+    }
+    _transcodedFrames++;
+    emit frameTranscoded(_transcodedFrames);
+
+    if (_transcodedFrames >= _frames.count())
+    {
+        _transcoding = false;
+        emit finished();
+    }
+}
+
+void DuEXR::decodeNext()
+{
+    while (_nextFrame < _frames.count() && _nextFrame < _fedFrames + _maxQueued)
+    {
+        _pool->start( new DecodeTask(this, _nextFrame) );
+        _nextFrame++;
+    }
+}
+
+DuEXR::DecodeTask::DecodeTask(DuEXR *decoder, int index)
+{
+    _decoder = decoder;
+    _index = index;
+    // Copy what's needed, the decoder is used by the main thread
+    _fileName = decoder->_frames.at(index);
+    _width = decoder->_width;
+    _height = decoder->_height;
+    _alpha = decoder->_alpha;
+}
+
+void DuEXR::DecodeTask::run()
+{
+    _decoder->addFrame( _index, DuEXR::decode(_fileName, _width, _height, _alpha) );
+}
+
+DuEXR::TranscodeTask::TranscodeTask(DuEXR *decoder, int index, QString outputFileName, OutputSettings settings)
+{
+    _decoder = decoder;
+    _index = index;
+    _inputFileName = decoder->_frames.at(index);
+    _outputFileName = outputFileName;
+    _settings = settings;
+}
+
+void DuEXR::TranscodeTask::run()
+{
+    bool ok = DuEXR::convert(_inputFileName, _outputFileName, _settings);
+    // Count it from the main thread
+    QMetaObject::invokeMethod(_decoder, "frameDone", Qt::QueuedConnection, Q_ARG(int, _index), Q_ARG(bool, ok));
 }
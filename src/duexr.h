@@ -2,15 +2,210 @@
 #define DUEXR_H
 
 #include <QObject>
+#include <QTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QSettings>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QDir>
+#include <QtDebug>
 
+#include "Renderer/abstractrenderer.h"
+
+/**
+ * @brief The DuEXR class reads and writes image sequences with OpenImageIO, each frame in its own thread.
+ * It either decodes EXR sequences and sends the frames to ffmpeg as raw video on its standard input (start()),
+ * or converts a sequence to another image sequence without ffmpeg (transcode()).
+ * When decoding, the frames are decoded a few frames ahead of ffmpeg, and sent in order.
+ * They are planar 32-bit float (gbrpf32le or gbrapf32le), the format the ffmpeg EXR decoder outputs,
+ * so that the filters and encoders work exactly as when ffmpeg reads the files.
+ * DuME has to be built with OpenImageIO (CONFIG+=oiio) to use it.
+ */
 class DuEXR : public QObject
 {
     Q_OBJECT
 public:
-    explicit DuEXR(QObject *parent = nullptr);
+    /**
+     * @brief Constructs a reader for an image sequence
+     * @param frames The files of the frames, in order
+     * @param parent The parent QObject
+     */
+    explicit DuEXR(QStringList frames, QObject *parent = nullptr);
+    ~DuEXR();
+
+    /**
+     * @brief The format of the frames written by transcode()
+     */
+    class OutputSettings
+    {
+    public:
+        // The channels to write, in order (R, G, B, A)
+        QStringList channels;
+        // The OpenImageIO data type (uint8, uint16, half, float), empty to keep the type of the input
+        QString format;
+        // The bits actually used when the data type is larger (10 or 12 bits DPX), 0 if they're all used
+        int bitsPerSample;
+        // The OpenImageIO compression (none, zip, piz, dwaa:45, jpeg:90...), empty for the default of the format
+        QString compression;
+    };
+
+    /**
+     * @brief Checks if DuME has been built with OpenImageIO
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Reads the size and channels of the sequence from its first frame
+     * @return false if the frames can't be decoded (no RGB channels...)
+     */
+    bool readSpec();
+    int width() const;
+    int height() const;
+    bool hasAlpha() const;
+    /**
+     * @brief The ffmpeg name of the pixel format of the frames
+     */
+    QString pixFormat() const;
+    /**
+     * @brief The size of a decoded frame, in Bytes
+     */
+    qint64 frameSize() const;
+
+    /**
+     * @brief Starts decoding and sending the frames
+     * @param target The renderer reading the frames on its standard input
+     */
+    void start(AbstractRenderer *target);
+    /**
+     * @brief Stops decoding, and closes the standard input of the target, or stops converting the frames
+     */
+    void stop();
+    /**
+     * @brief The number of frames already sent
+     */
+    int numFedFrames() const;
+
+    /**
+     * @brief Converts all the frames to another image sequence, in parallel. stop() cancels the frames not started yet.
+     * @param outputFileName The name of the output sequence, with {###} blocks for the frame number
+     * @param startNumber The number of the first frame written
+     * @param settings The format of the output frames
+     */
+    void transcode(QString outputFileName, int startNumber, OutputSettings settings);
+    /**
+     * @brief The input frames which could not be converted by transcode()
+     */
+    QStringList failedFrames() const;
+    /**
+     * @brief Checks if the frames with this extension can be converted by transcode()
+     */
+    static bool isSupported(QString extension);
 
 signals:
+    /**
+     * @brief Emitted when all the frames have been sent, or converted
+     */
+    void finished();
+    /**
+     * @brief Emitted each time transcode() has converted a frame
+     * @param numFrames The number of frames converted so far
+     */
+    void frameTranscoded(int numFrames);
+
+private slots:
+    // Sends the decoded frames, in order, and decodes the next ones
+    void feed();
+    // Counts the converted frames
+    void frameDone(int index, bool ok);
+
+private:
+    /**
+     * @brief Decodes a frame in a thread of the pool
+     */
+    class DecodeTask : public QRunnable
+    {
+    public:
+        DecodeTask(DuEXR *decoder, int index);
+        void run();
+    private:
+        DuEXR *_decoder;
+        int _index;
+        QString _fileName;
+        int _width;
+        int _height;
+        bool _alpha;
+    };
+
+    /**
+     * @brief Converts a frame in a thread of the pool
+     */
+    class TranscodeTask : public QRunnable
+    {
+    public:
+        TranscodeTask(DuEXR *decoder, int index, QString outputFileName, OutputSettings settings);
+        void run();
+    private:
+        DuEXR *_decoder;
+        int _index;
+        QString _inputFileName;
+        QString _outputFileName;
+        OutputSettings _settings;
+    };
+
+    /**
+     * @brief Reads a frame and converts it to planar float
+     * @return The frame, or an empty QByteArray if it can't be read
+     */
+    static QByteArray decode(QString fileName, int width, int height, bool alpha);
+    /**
+     * @brief Reads a frame and writes it with other settings
+     * @return false if the frame can't be read or written
+     */
+    static bool convert(QString inputFileName, QString outputFileName, OutputSettings settings);
+    /**
+     * @brief Replaces the {###} blocks of a sequence name with a frame number
+     */
+    static QString frameFileName(QString sequenceName, int number);
+    /**
+     * @brief Stores a decoded frame, called from the decoding threads
+     */
+    void addFrame(int index, QByteArray frame);
+    /**
+     * @brief Takes a decoded frame out of the queue
+     * @param ready Set to false if the frame has not been decoded yet
+     */
+    QByteArray takeFrame(int index, bool &ready);
+    /**
+     * @brief Launches the decoding of the next frames, as long as the queue is not full
+     */
+    void decodeNext();
+
+    QStringList _frames;
+    int _width;
+    int _height;
+    bool _alpha;
+
+    AbstractRenderer *_target;
+    QTimer *_timer;
+    QThreadPool *_pool;
+    // The frames decoded and not sent yet, by index
+    QHash<int, QByteArray> _decodedFrames;
+    QMutex _mutex;
+    // The maximum number of frames decoded ahead of ffmpeg
+    int _maxQueued;
+    int _nextFrame;
+    int _fedFrames;
 
+    // Converting the frames with transcode()
+    bool _transcoding;
+    int _transcodedFrames;
+    QStringList _failedFrames;
 };
 
 #endif // DUEXR_H
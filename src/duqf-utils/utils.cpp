@@ -199,6 +199,16 @@ double MediaUtils::timecodeToDuration(QString timecode)
     return 0.0;
 }
 
+double MediaUtils::rationalToDouble(QString rational)
+{
+    QStringList r = rational.split("/");
+    double num = r[0].toDouble();
+    if (r.count() == 1) return num;
+    double den = r[1].toDouble();
+    if (den == 0.0) return 0.0;
+    return num / den;
+}
+
 MediaUtils::DeinterlaceParity MediaUtils::DeinterlaceParityFromString(QString parity)
 {
     if (parity == "TopFieldFirst") return TopFieldFirst;
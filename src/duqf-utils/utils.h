@@ -107,6 +107,12 @@ namespace MediaUtils
     QString durationToTimecode(double duration);
 
     double timecodeToDuration(QString timecode);
+    /**
+     * @brief Converts a rational number as printed by ffmpeg (e.g. "30000/1001") to a double
+     * @param rational The rational number
+     * @return The value, 0.0 if the rational is invalid or the denominator is 0
+     */
+    double rationalToDouble(QString rational);
 
     /**
      * @brief convertBitrate Converts a bitrate from bps to another unit.
@@ -9,6 +9,10 @@
 
 #include "duqf-app/app-utils.h"
 #include "UI/mainwindow.h"
+#include "Renderer/batchrunner.h"
+#include "Renderer/jobserver.h"
+#include "Renderer/farmnode.h"
+#include "Renderer/farmcoordinator.h"
 
 // Process the CLI arguments
 bool processArgs(int argc, char *argv[])
@@ -36,9 +40,22 @@ bool processArgs(int argc, char *argv[])
     return presets;
 }
 
-void initSettings(DuSplashScreen *s)
+// Checks if an option is used, and gets its value
+bool getArg(int argc, char *argv[], QString name, QString &value)
 {
-    s->newMessage("Reading settings...");
+    for (int i = 1; i < argc; i++)
+    {
+        QString arg = argv[i];
+        if (arg.toLower() != name) continue;
+        if (i < argc - 1 && !QString(argv[i+1]).startsWith("-")) value = argv[i+1];
+        return true;
+    }
+    return false;
+}
+
+void initSettings(DuSplashScreen *s = nullptr)
+{
+    if (s) s->newMessage("Reading settings...");
     QSettings settings;
     QString prevVersionStr = settings.value("version", "").toString();
     QVersionNumber prevVersion = QVersionNumber::fromString( prevVersionStr );
@@ -64,6 +81,101 @@ void initFFmpeg(DuSplashScreen *s)
     ffmpeg->init();
 }
 
+void initFFmpeg()
+{
+    qInfo() << "Initializing FFmpeg...";
+    FFmpeg::instance()->init();
+}
+
+// Initializes the application without any UI
+void initCore(QCoreApplication *a)
+{
+    a->setOrganizationName(STR_COMPANYNAME);
+    a->setOrganizationDomain(STR_COMPANYDOMAIN);
+    a->setApplicationName(STR_PRODUCTNAME);
+    a->setApplicationVersion(STR_VERSION);
+
+    //load presets
+    PresetManager::instance()->load();
+    // init settings
+    initSettings();
+    //load FFmpeg
+    initFFmpeg();
+    //Init cache manager
+    CacheManager::instance()->init();
+}
+
+// Renders the jobs of the job file without any UI, and quits
+int runHeadless(int argc, char *argv[], QString jobFile)
+{
+    QCoreApplication a(argc, argv);
+    initCore(&a);
+
+    BatchRunner runner(jobFile);
+    if (!runner.start())
+    {
+        qCritical().noquote() << runner.error();
+        return 2;
+    }
+
+    return a.exec();
+}
+
+// Waits for jobs on a local socket, without any UI
+int runDaemon(int argc, char *argv[], QString name)
+{
+    QCoreApplication a(argc, argv);
+    initCore(&a);
+
+    JobServer server(name);
+    if (!server.listen())
+    {
+        qCritical().noquote() << server.error();
+        return 2;
+    }
+    qInfo().noquote() << "Waiting for jobs on " + server.serverName();
+
+    return a.exec();
+}
+
+// Renders work units from a shared farm folder, or submits and merges jobs
+int runFarm(int argc, char *argv[], QString farmPath)
+{
+    QCoreApplication a(argc, argv);
+    initCore(&a);
+
+    QString jobFile = "";
+    if (getArg(argc, argv, "--submit", jobFile))
+    {
+        QString split = "0";
+        getArg(argc, argv, "--split", split);
+        FarmCoordinator coordinator(farmPath);
+        if (coordinator.submit(jobFile, split.toInt()) < 0)
+        {
+            qCritical().noquote() << coordinator.error();
+            return 2;
+        }
+        return 0;
+    }
+
+    QString dummy;
+    if (getArg(argc, argv, "--merge", dummy))
+    {
+        FarmCoordinator coordinator(farmPath);
+        coordinator.merge();
+        return a.exec();
+    }
+
+    FarmNode node(farmPath);
+    if (!node.start())
+    {
+        qCritical().noquote() << node.error();
+        return 2;
+    }
+
+    return a.exec();
+}
+
 void buildUI(QStringList args, DuSplashScreen *s)
 {
     s->newMessage("Building UI");
@@ -79,6 +191,16 @@ void buildUI(QStringList args, DuSplashScreen *s)
 
 int main(int argc, char *argv[])
 {
+    // Render nodes: no UI, logs on stderr and a summary on stdout
+    QString jobFile = "";
+    if (getArg(argc, argv, "--headless", jobFile) && jobFile != "") return runHeadless(argc, argv, jobFile);
+    // Pipeline tools: no UI, the jobs are submitted on a local socket
+    QString serverName = "DuME";
+    if (getArg(argc, argv, "--daemon", serverName)) return runDaemon(argc, argv, serverName);
+    // Several nodes sharing a farm folder
+    QString farmPath = "";
+    if (getArg(argc, argv, "--farm", farmPath) && farmPath != "") return runFarm(argc, argv, farmPath);
+
     DuApplication a(argc, argv);
 
     //load presets
@@ -95,6 +217,12 @@ int main(int argc, char *argv[])
     QStringList helpStrings;
     helpStrings << "    --minimize / -m         Minimizes the window as soon as it is ready.";
     helpStrings << "    --help:presets / -h:p   Prints the list of available presets";
+    helpStrings << "    --headless jobfile      Renders the jobs listed in the JSON job file without any UI, prints a JSON summary and quits. The exit code is 0 if all jobs succeeded, 1 if some failed, 2 if the job file is invalid.";
+    helpStrings << "    --daemon [name]         Runs without any UI and waits for jobs on the local socket \"name\" (\"DuME\" by default). The jobs use the same format as the job files.";
+    helpStrings << "    --farm folder           Runs a render node without any UI, rendering the work units queued in the shared farm folder.";
+    helpStrings << "    --farm folder --submit jobfile [--split frames]";
+    helpStrings << "                            Queues the jobs of the job file in the farm folder. Jobs rendering image sequences can be split in units of the given number of frames.";
+    helpStrings << "    --farm folder --merge   Waits for all the units of the farm folder to be rendered, prints a JSON summary of the jobs and quits.";
     helpStrings << "";
     helpStrings << "Global Input Options";
     helpStrings << "    --color-profile profile     The input color profile. One of: srgb, bt709, bt2020_10, bt2020_12";